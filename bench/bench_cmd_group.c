@@ -0,0 +1,170 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define GROUPS_NUM (64U)
+#define GROUP_COMMANDS_NUM (32U)
+#define COMMANDS_NUM (GROUPS_NUM * GROUP_COMMANDS_NUM)
+#define NAME_SIZE (16U)
+#define LINES_NUM (256U)
+
+static struct cat_command cmds[GROUPS_NUM][GROUP_COMMANDS_NUM];
+static char names[GROUPS_NUM][GROUP_COMMANDS_NUM][NAME_SIZE];
+static struct cat_command_group cmd_groups[GROUPS_NUM];
+static struct cat_command_group *cmd_desc[GROUPS_NUM];
+static uint8_t buf[COMMANDS_NUM / 2];
+static struct cat_command const *cmd_table[COMMANDS_NUM];
+static uint8_t cmd_disable_buf[COMMANDS_NUM / 8];
+
+static char input_text[LINES_NUM * 32];
+static size_t input_index;
+static size_t input_length;
+
+static size_t run_cntr;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        (void)cmd;
+        run_cntr++;
+        return CAT_RETURN_STATE_OK;
+}
+
+static int write_char(char ch)
+{
+        (void)ch;
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= input_length)
+                return 0;
+
+        *ch = input_text[input_index++];
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static double get_time_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void prepare_commands(void)
+{
+        size_t i;
+        size_t j;
+
+        memset(cmds, 0, sizeof(cmds));
+        for (i = 0; i < GROUPS_NUM; i++) {
+                for (j = 0; j < GROUP_COMMANDS_NUM; j++) {
+                        snprintf(names[i][j], sizeof(names[i][j]), "+G%02uC%02u", (unsigned)i, (unsigned)j);
+                        cmds[i][j].name = names[i][j];
+                        cmds[i][j].run = cmd_run;
+                }
+                cmd_groups[i].cmd = cmds[i];
+                cmd_groups[i].cmd_num = GROUP_COMMANDS_NUM;
+                cmd_desc[i] = &cmd_groups[i];
+        }
+}
+
+static void prepare_input(void)
+{
+        size_t i;
+        size_t n;
+
+        input_length = 0;
+        for (i = 0; i < LINES_NUM; i++) {
+                n = (i * 7919U) % COMMANDS_NUM;
+                input_length += sprintf(&input_text[input_length], "AT%s\n", names[n / GROUP_COMMANDS_NUM][n % GROUP_COMMANDS_NUM]);
+        }
+
+        input_index = 0;
+        run_cntr = 0;
+}
+
+static void bench(bool use_table)
+{
+        struct cat_object at;
+        struct cat_descriptor desc = {
+                .cmd_group = cmd_desc,
+                .cmd_group_num = GROUPS_NUM,
+
+                .buf = buf,
+                .buf_size = sizeof(buf),
+
+                .cmd_table = (use_table != false) ? cmd_table : NULL,
+                .cmd_table_num = (use_table != false) ? COMMANDS_NUM : 0,
+
+                .cmd_disable_buf = (use_table != false) ? cmd_disable_buf : NULL,
+                .cmd_disable_buf_size = (use_table != false) ? sizeof(cmd_disable_buf) : 0
+        };
+        size_t service_cntr = 0;
+        double t;
+
+        prepare_input();
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        t = get_time_ns();
+        while (cat_service(&at) != 0)
+                service_cntr++;
+        t = get_time_ns() - t;
+
+        assert(run_cntr == LINES_NUM);
+
+        printf("%8u %8u %8s %16.1f %16.1f\n", GROUPS_NUM, COMMANDS_NUM, (use_table != false) ? "table" : "groups", (double)service_cntr / LINES_NUM, t / LINES_NUM);
+}
+
+int main(int argc, char **argv)
+{
+        (void)argc;
+        (void)argv;
+
+        prepare_commands();
+
+        printf("%8s %8s %8s %16s %16s\n", "groups", "commands", "lookup", "service/command", "ns/command");
+
+        bench(false);
+        bench(true);
+
+        return 0;
+}
@@ -0,0 +1,255 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define MAX_COMMANDS_NUM (1024U)
+#define NAME_SIZE (16U)
+#define LINES_NUM (256U)
+
+typedef enum {
+        MATCH_SCAN,
+        MATCH_LIST,
+        MATCH_INDEX,
+        MATCH__TOTAL_NUM
+} match_mode;
+
+static char const *match_names[MATCH__TOTAL_NUM] = {
+        "scan",
+        "list",
+        "index"
+};
+
+static struct cat_command cmds[MAX_COMMANDS_NUM];
+static char names[MAX_COMMANDS_NUM][NAME_SIZE];
+static uint8_t buf[MAX_COMMANDS_NUM];
+static struct cat_command_index cmd_index[MAX_COMMANDS_NUM];
+static size_t cmd_candidate[MAX_COMMANDS_NUM];
+static struct cat_command_meta cmd_meta[MAX_COMMANDS_NUM];
+static char cmd_name_buf[MAX_COMMANDS_NUM * NAME_SIZE];
+
+static char input_text[LINES_NUM * 32];
+static size_t input_index;
+static size_t input_length;
+
+static size_t run_cntr;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        (void)cmd;
+        run_cntr++;
+        return CAT_RETURN_STATE_OK;
+}
+
+static int write_char(char ch)
+{
+        (void)ch;
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= input_length)
+                return 0;
+
+        *ch = input_text[input_index++];
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static double get_time_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* prefix families with realistic share (most commands are +C ones) and not being prefix of each other */
+static char const *families[] = {
+        "+C",
+        "+C",
+        "+C",
+        "+Q",
+        "+S",
+        "$",
+        "#",
+        "&"
+};
+
+#define FAMILIES_NUM (sizeof(families) / sizeof(families[0]))
+
+static void prepare_commands(size_t num)
+{
+        size_t i;
+        size_t n;
+        size_t len;
+        size_t k;
+        char *name;
+
+        memset(cmds, 0, sizeof(cmds));
+        for (i = 0; i < num; i++) {
+                name = names[i];
+                strcpy(name, families[i % FAMILIES_NUM]);
+
+                /* suffix is number of command within family in base 26 padded with leading 'A' to varied length */
+                n = i / FAMILIES_NUM;
+                len = 2 + (i * 5U) % 5;
+                name += strlen(name);
+                for (k = len; k > 0; k--) {
+                        name[k - 1] = 'A' + (n % 26);
+                        n /= 26;
+                }
+                name[len] = 0;
+                assert(n == 0);
+
+                cmds[i].name = names[i];
+                cmds[i].run = cmd_run;
+        }
+}
+
+static void prepare_input(size_t num)
+{
+        size_t i;
+
+        input_length = 0;
+        for (i = 0; i < LINES_NUM; i++)
+                input_length += sprintf(&input_text[input_length], "AT%s\n", names[(i * 7919U) % num]);
+
+        input_index = 0;
+        run_cntr = 0;
+}
+
+/* number of commands still matching after every name char of input (what candidates list and index are pruned to) */
+static void count_candidates(size_t num, double *avg, size_t *max)
+{
+        size_t i;
+        size_t j;
+        size_t k;
+        size_t n;
+        size_t sum = 0;
+        size_t chars = 0;
+        char const *name;
+
+        *max = 0;
+        for (i = 0; i < LINES_NUM; i++) {
+                name = names[(i * 7919U) % num];
+                for (k = 1; k <= strlen(name); k++) {
+                        n = 0;
+                        for (j = 0; j < num; j++) {
+                                if (strncmp(names[j], name, k) == 0)
+                                        n++;
+                        }
+                        sum += n;
+                        chars++;
+                        if (n > *max)
+                                *max = n;
+                }
+        }
+        *avg = (double)sum / chars;
+}
+
+static void bench(size_t num, match_mode match, bool use_meta)
+{
+        struct cat_object at;
+        struct cat_command_group cmd_group = {
+                .cmd = cmds,
+                .cmd_num = num,
+        };
+        struct cat_command_group *cmd_desc[] = {
+                &cmd_group
+        };
+        struct cat_descriptor desc = {
+                .cmd_group = cmd_desc,
+                .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+                .buf = buf,
+                .buf_size = sizeof(buf),
+
+                .cmd_index = (match == MATCH_INDEX) ? cmd_index : NULL,
+                .cmd_index_num = (match == MATCH_INDEX) ? num : 0,
+
+                .cmd_candidate = (match == MATCH_LIST) ? cmd_candidate : NULL,
+                .cmd_candidate_num = (match == MATCH_LIST) ? num : 0,
+
+                .cmd_meta = (use_meta != false) ? cmd_meta : NULL,
+                .cmd_meta_num = (use_meta != false) ? num : 0,
+                .cmd_name_buf = (use_meta != false) ? cmd_name_buf : NULL,
+                .cmd_name_buf_size = (use_meta != false) ? sizeof(cmd_name_buf) : 0
+        };
+        size_t service_cntr = 0;
+        double t;
+        double cand_avg;
+        size_t cand_max;
+
+        prepare_commands(num);
+        prepare_input(num);
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        t = get_time_ns();
+        while (cat_service(&at) != 0)
+                service_cntr++;
+        t = get_time_ns() - t;
+
+        assert(run_cntr == LINES_NUM);
+
+        count_candidates(num, &cand_avg, &cand_max);
+
+        printf("%8u %8s %8s %16.1f %16.1f %12.1f %12u\n", (unsigned)num, match_names[match], (use_meta != false) ? "yes" : "no", (double)service_cntr / LINES_NUM, t / LINES_NUM,
+               cand_avg, (unsigned)cand_max);
+}
+
+int main(int argc, char **argv)
+{
+        size_t num;
+        int match;
+
+        (void)argc;
+        (void)argv;
+
+        printf("%8s %8s %8s %16s %16s %12s %12s\n", "commands", "match", "meta", "service/command", "ns/command", "cand/char", "cand max");
+
+        for (num = 16; num <= MAX_COMMANDS_NUM; num <<= 1) {
+                for (match = 0; match < MATCH__TOTAL_NUM; match++) {
+                        bench(num, (match_mode)match, false);
+                        bench(num, (match_mode)match, true);
+                }
+        }
+
+        return 0;
+}
@@ -0,0 +1,253 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define COMMANDS_NUM (512U)
+#define SESSIONS_NUM (256U)
+#define NAME_SIZE (8U)
+
+/* without commands index matching bitmap (2 bits per command) lives in atcmd half of working buffer */
+#define SEPARATE_BUF_SIZE (2U * COMMANDS_NUM / 4U)
+/* with commands index working buffer holds only arguments */
+#define SESSION_BUF_SIZE (64U)
+
+/* per session storage before split (0.10.1 on LP64 targets): */
+/* parser object with embedded unsolicited fsm and own descriptor with working buffer */
+#define BASELINE_OBJECT_SIZE (240U)
+#define BASELINE_DESCRIPTOR_SIZE (48U)
+#define BASELINE_SESSION_SIZE (BASELINE_OBJECT_SIZE + BASELINE_DESCRIPTOR_SIZE + SEPARATE_BUF_SIZE)
+
+typedef enum {
+        MODE_SEPARATE,
+        MODE_SHARED,
+        MODE_SHARED_UNSOLICITED,
+        MODE__TOTAL_NUM
+} bench_mode;
+
+static char const *mode_names[MODE__TOTAL_NUM] = {
+        "separate",
+        "shared",
+        "shared+u"
+};
+
+static struct cat_command cmds[COMMANDS_NUM];
+static char names[COMMANDS_NUM][NAME_SIZE];
+static struct cat_command_group cmd_group;
+static struct cat_command_group *cmd_desc[1];
+
+/* storage of separately initialized objects (every object has own descriptor like before split) */
+static struct cat_descriptor descs[SESSIONS_NUM];
+static uint8_t separate_bufs[SESSIONS_NUM][SEPARATE_BUF_SIZE];
+
+/* storage of sessions using shared commands table */
+static struct cat_table table;
+static struct cat_descriptor shared_desc;
+static struct cat_command_index cmd_index[COMMANDS_NUM];
+static struct cat_command_meta cmd_meta[COMMANDS_NUM];
+static char cmd_name_buf[COMMANDS_NUM * NAME_SIZE];
+
+static uint8_t bufs[SESSIONS_NUM][SESSION_BUF_SIZE];
+static struct cat_unsolicited_fsm unsolicited_fsms[SESSIONS_NUM];
+static struct cat_object objects[SESSIONS_NUM];
+
+static size_t input_index[SESSIONS_NUM];
+static struct cat_io_interface ifaces[SESSIONS_NUM];
+static const char *input_text = "AT+C100\nAT+C511\n";
+
+static size_t run_cntr;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        (void)cmd;
+        run_cntr++;
+        return CAT_RETURN_STATE_OK;
+}
+
+static int write_char(void *ctx, char ch)
+{
+        (void)ctx;
+        (void)ch;
+        return 1;
+}
+
+static int read_char(void *ctx, char *ch)
+{
+        size_t *index = ctx;
+
+        if (input_text[*index] == 0)
+                return 0;
+
+        *ch = input_text[(*index)++];
+        return 1;
+}
+
+static double get_time_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void prepare_commands(void)
+{
+        size_t i;
+
+        memset(cmds, 0, sizeof(cmds));
+        for (i = 0; i < COMMANDS_NUM; i++) {
+                snprintf(names[i], sizeof(names[i]), "+C%u", (unsigned)i);
+                cmds[i].name = names[i];
+                cmds[i].run = cmd_run;
+        }
+        cmd_group.cmd = cmds;
+        cmd_group.cmd_num = COMMANDS_NUM;
+        cmd_desc[0] = &cmd_group;
+}
+
+static void prepare_sessions(void)
+{
+        size_t i;
+
+        run_cntr = 0;
+        for (i = 0; i < SESSIONS_NUM; i++) {
+                input_index[i] = 0;
+                ifaces[i].ctx = &input_index[i];
+                ifaces[i].read_ctx = read_char;
+                ifaces[i].write_ctx = write_char;
+        }
+}
+
+static void service_sessions(void)
+{
+        size_t i;
+        size_t busy;
+
+        do {
+                busy = 0;
+                for (i = 0; i < SESSIONS_NUM; i++) {
+                        if (cat_service(&objects[i]) != CAT_STATUS_OK)
+                                busy++;
+                }
+        } while (busy > 0);
+
+        assert(run_cntr == 2 * SESSIONS_NUM);
+}
+
+static void bench(bench_mode mode)
+{
+        struct cat_session_config config;
+        size_t i;
+        size_t shared_size;
+        size_t session_size;
+        double t;
+
+        prepare_sessions();
+
+        t = get_time_ns();
+        if (mode == MODE_SEPARATE) {
+                for (i = 0; i < SESSIONS_NUM; i++) {
+                        memset(&descs[i], 0, sizeof(descs[i]));
+                        descs[i].cmd_group = cmd_desc;
+                        descs[i].cmd_group_num = 1;
+                        descs[i].buf = separate_bufs[i];
+                        descs[i].buf_size = sizeof(separate_bufs[i]);
+                        descs[i].unsolicited_fsm = &unsolicited_fsms[i];
+
+                        cat_init(&objects[i], &descs[i], &ifaces[i], NULL);
+                }
+        } else {
+                shared_desc.cmd_group = cmd_desc;
+                shared_desc.cmd_group_num = 1;
+                shared_desc.cmd_index = cmd_index;
+                shared_desc.cmd_index_num = COMMANDS_NUM;
+                shared_desc.cmd_meta = cmd_meta;
+                shared_desc.cmd_meta_num = COMMANDS_NUM;
+                shared_desc.cmd_name_buf = cmd_name_buf;
+                shared_desc.cmd_name_buf_size = sizeof(cmd_name_buf);
+
+                cat_table_init(&table, &shared_desc);
+                for (i = 0; i < SESSIONS_NUM; i++) {
+                        memset(&config, 0, sizeof(config));
+                        config.buf = bufs[i];
+                        config.buf_size = sizeof(bufs[i]);
+                        config.unsolicited_fsm = (mode == MODE_SHARED_UNSOLICITED) ? &unsolicited_fsms[i] : NULL;
+                        cat_init_session(&objects[i], &table, &config, &ifaces[i], NULL);
+                }
+        }
+        t = get_time_ns() - t;
+
+        service_sessions();
+
+        /* separate objects support unsolicited events like before split, so their fsm storage is counted */
+        switch (mode) {
+        case MODE_SEPARATE:
+                shared_size = 0;
+                session_size = sizeof(objects[0]) + sizeof(unsolicited_fsms[0]) + sizeof(descs[0]) + sizeof(separate_bufs[0]);
+                break;
+        case MODE_SHARED:
+                shared_size = sizeof(table) + sizeof(shared_desc) + sizeof(cmd_index) + sizeof(cmd_meta) + sizeof(cmd_name_buf);
+                session_size = sizeof(objects[0]) + sizeof(bufs[0]);
+                break;
+        default:
+                shared_size = sizeof(table) + sizeof(shared_desc) + sizeof(cmd_index) + sizeof(cmd_meta) + sizeof(cmd_name_buf);
+                session_size = sizeof(objects[0]) + sizeof(unsolicited_fsms[0]) + sizeof(bufs[0]);
+                break;
+        }
+
+        printf("%8s %8u %8u %12zu %12zu %12.2f %12zu %12.1f\n", mode_names[mode], COMMANDS_NUM, SESSIONS_NUM,
+               shared_size, session_size, (double)session_size / BASELINE_SESSION_SIZE, shared_size + session_size * SESSIONS_NUM, t / SESSIONS_NUM);
+}
+
+int main(int argc, char **argv)
+{
+        int mode;
+
+        (void)argc;
+        (void)argv;
+
+        prepare_commands();
+
+        printf("sizeof(struct cat_object) = %zu (baseline %u with embedded unsolicited fsm)\n", sizeof(struct cat_object), BASELINE_OBJECT_SIZE);
+        printf("sizeof(struct cat_unsolicited_fsm) = %zu\n", sizeof(struct cat_unsolicited_fsm));
+        printf("sizeof(struct cat_table) = %zu\n", sizeof(struct cat_table));
+        printf("sizeof(struct cat_descriptor) = %zu (baseline %u)\n", sizeof(struct cat_descriptor), BASELINE_DESCRIPTOR_SIZE);
+        printf("baseline session B = %u (object + descriptor + %u B working buffer)\n\n", BASELINE_SESSION_SIZE, SEPARATE_BUF_SIZE);
+
+        printf("%8s %8s %8s %12s %12s %12s %12s %12s\n", "tables", "commands", "sessions", "shared B", "session B", "/baseline", "total B", "ns/init");
+
+        for (mode = 0; mode < MODE__TOTAL_NUM; mode++)
+                bench((bench_mode)mode);
+
+        return 0;
+}
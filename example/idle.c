@@ -0,0 +1,217 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+ * Linux example measuring idle cpu usage of host loop with and without wait hints.
+ * Single parser session is bound to socket pair, other thread plays slow client
+ * (one command every 100 ms). Busy polling loop calls cat_service all the time,
+ * hinted loop sleeps in poll on event reported by cat_get_wait_hint.
+ *
+ * usage: idle [seconds per mode]
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define COMMAND_PERIOD_US (100000U)
+
+static int fds[2];
+static atomic_bool client_done;
+static size_t ok_cntr;
+
+static cat_return_state ping_run(const struct cat_command *cmd)
+{
+        (void)cmd;
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+PING",
+                .run = ping_run
+        }
+};
+
+static char buf[128];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+};
+
+static int write_char(void *ctx, char ch)
+{
+        return (write(*(int *)ctx, &ch, 1) == 1) ? 1 : 0;
+}
+
+static int read_char(void *ctx, char *ch)
+{
+        return (read(*(int *)ctx, ch, 1) == 1) ? 1 : 0;
+}
+
+static struct cat_io_interface iface = {
+        .ctx = &fds[0],
+        .read_ctx = read_char,
+        .write_ctx = write_char
+};
+
+static double get_time_s(clockid_t clk)
+{
+        struct timespec ts;
+
+        clock_gettime(clk, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* slow client sending single command every period and counting responses */
+static void* client_thread(void *arg)
+{
+        double duration = *(double *)arg;
+        double start = get_time_s(CLOCK_MONOTONIC);
+        char rsp[64];
+        ssize_t n;
+        ssize_t i;
+
+        while (get_time_s(CLOCK_MONOTONIC) - start < duration) {
+                if (write(fds[1], "AT+PING\n", 8) != 8)
+                        break;
+                usleep(COMMAND_PERIOD_US);
+
+                n = read(fds[1], rsp, sizeof(rsp));
+                for (i = 0; i + 1 < n; i++) {
+                        if ((rsp[i] == 'O') && (rsp[i + 1] == 'K'))
+                                ok_cntr++;
+                }
+        }
+
+        atomic_store(&client_done, true);
+        return NULL;
+}
+
+static void wait_for_event(cat_wait_hint hint)
+{
+        struct pollfd pfd = {
+                .fd = fds[0]
+        };
+
+        switch (hint) {
+        case CAT_WAIT_HINT_INPUT:
+        case CAT_WAIT_HINT_HOLD:
+                pfd.events = POLLIN;
+                break;
+        case CAT_WAIT_HINT_OUTPUT:
+                pfd.events = POLLIN | POLLOUT;
+                break;
+        case CAT_WAIT_HINT_RATE_LIMIT:
+                usleep(1000);
+                return;
+        default:
+                return;
+        }
+
+        /* timeout only to notice end of measurement */
+        poll(&pfd, 1, 50);
+}
+
+static void measure(bool use_hints, double duration)
+{
+        struct cat_object at;
+        pthread_t client;
+        cat_wait_hint hint;
+        double wall;
+        double cpu;
+
+        cat_init(&at, &desc, &iface, NULL);
+        atomic_store(&client_done, false);
+        ok_cntr = 0;
+
+        wall = get_time_s(CLOCK_MONOTONIC);
+        cpu = get_time_s(CLOCK_THREAD_CPUTIME_ID);
+
+        pthread_create(&client, NULL, client_thread, &duration);
+
+        while (atomic_load(&client_done) == false) {
+                cat_service_run(&at, 64, NULL);
+                if (use_hints == false)
+                        continue;
+
+                cat_get_wait_hint(&at, &hint);
+                wait_for_event(hint);
+        }
+
+        pthread_join(client, NULL);
+
+        wall = get_time_s(CLOCK_MONOTONIC) - wall;
+        cpu = get_time_s(CLOCK_THREAD_CPUTIME_ID) - cpu;
+
+        printf("%12s %10.2f %10.3f %8.1f%% %10zu\n", (use_hints != false) ? "wait hints" : "busy poll", wall, cpu, 100.0 * cpu / wall, ok_cntr);
+}
+
+int main(int argc, char **argv)
+{
+        double duration = (argc > 1) ? atof(argv[1]) : 2.0;
+
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                perror("socketpair");
+                return 1;
+        }
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+        printf("%12s %10s %10s %9s %10s\n", "loop", "wall s", "cpu s", "cpu", "responses");
+
+        measure(false, duration);
+        measure(true, duration);
+
+        return 0;
+}
@@ -0,0 +1,550 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+ * Linux host runtime example: single epoll loop owning many parser sessions.
+ * Sessions are bound to unix-domain socket connections (and optionally to pseudo-terminals),
+ * all of them share one commands table. Parser is serviced only for readable or writable sessions,
+ * unsolicited events are triggered by separate ticker thread (lock-free) and routed by eventfd.
+ *
+ * usage: server <socket path> [number of pseudo-terminals]
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define SESSIONS_MAX (1024U)
+#define SESSION_BUF_SIZE (128U)
+#define SESSION_INPUT_SIZE (512U)
+#define SESSION_OUTPUT_SIZE (2048U)
+#define SERVICE_STEPS (4096U)
+#define EVENTS_NUM (64U)
+
+/* epoll data tags of not session descriptors */
+#define TAG_LISTEN (SESSIONS_MAX)
+#define TAG_EVENT (SESSIONS_MAX + 1U)
+
+struct session {
+        int fd; /* socket or pseudo-terminal master descriptor */
+        bool pty; /* pseudo-terminal session (never closed) */
+        uint32_t events; /* currently armed epoll events */
+
+        struct cat_object at; /* parser session */
+        struct cat_io_interface iface; /* io interface with session context */
+        uint8_t buf[SESSION_BUF_SIZE]; /* session working buffer */
+        struct cat_unsolicited_fsm unsolicited_fsm; /* session unsolicited events fsm */
+        struct cat_unsolicited_cmd unsolicited_cmd_buf[4]; /* session unsolicited events queue */
+
+        char input[SESSION_INPUT_SIZE];
+        size_t input_pos;
+        size_t input_len;
+
+        char output[SESSION_OUTPUT_SIZE];
+        size_t output_pos;
+        size_t output_len;
+
+        atomic_bool active; /* session is initialized and can be triggered */
+        atomic_bool tick; /* periodic unsolicited event enabled */
+        atomic_bool kick; /* unsolicited event triggered from other thread */
+};
+
+static struct session sessions[SESSIONS_MAX];
+
+static int epoll_fd;
+static int event_fd;
+
+/* session serviced by loop (command handlers have no context) */
+static struct session *current_session;
+
+/* set by ticker thread while it walks over sessions */
+static atomic_bool ticker_pass;
+static atomic_uint ticks;
+
+static uint8_t tick_enable;
+
+static int tick_write(const struct cat_variable *var, const size_t write_size)
+{
+        (void)var;
+        (void)write_size;
+
+        if (tick_enable > 1)
+                return -1;
+
+        atomic_store(&current_session->tick, tick_enable != 0);
+        return 0;
+}
+
+static cat_return_state tick_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        (void)cmd;
+
+        *data_size += snprintf((char *)&data[*data_size], max_data_size - *data_size, "%u", atomic_load(&ticks));
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static cat_return_state session_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        (void)cmd;
+
+        *data_size += snprintf((char *)&data[*data_size], max_data_size - *data_size, "%u", (unsigned)(current_session - sessions));
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static cat_return_state ping_run(const struct cat_command *cmd)
+{
+        (void)cmd;
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state print_cmd_list(const struct cat_command *cmd)
+{
+        (void)cmd;
+        return CAT_RETURN_STATE_PRINT_CMD_LIST_OK;
+}
+
+static struct cat_variable tick_vars[] = {
+        {
+                .type = CAT_VAR_UINT_DEC,
+                .data = &tick_enable,
+                .data_size = sizeof(tick_enable),
+                .name = "ENABLE",
+                .write = tick_write,
+                .access = CAT_VAR_ACCESS_WRITE_ONLY
+        }
+};
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+PING",
+                .description = "Empty command (load generator target).",
+                .run = ping_run
+        },
+        {
+                .name = "+TICK",
+                .description = "Periodic unsolicited ticks counter (write 1 to enable, 0 to disable).",
+                .read = tick_read,
+                .var = tick_vars,
+                .var_num = sizeof(tick_vars) / sizeof(tick_vars[0]),
+                .need_all_vars = true
+        },
+        {
+                .name = "+SESSION",
+                .description = "Index of current session.",
+                .read = session_read
+        },
+        {
+                .name = "#HELP",
+                .run = print_cmd_list
+        }
+};
+
+static struct cat_command_index cmd_index[sizeof(cmds) / sizeof(cmds[0])];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+/* descriptor shared by all sessions */
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .cmd_index = cmd_index,
+        .cmd_index_num = sizeof(cmd_index) / sizeof(cmd_index[0])
+};
+
+static struct cat_table table;
+
+/* session io is buffered, descriptors are read and written only by epoll loop */
+static int session_read_char(void *ctx, char *ch)
+{
+        struct session *s = ctx;
+
+        if (s->input_pos >= s->input_len)
+                return 0;
+
+        *ch = s->input[s->input_pos++];
+        return 1;
+}
+
+static size_t session_write_block(void *ctx, const char *buf, size_t len)
+{
+        struct session *s = ctx;
+        size_t n = SESSION_OUTPUT_SIZE - s->output_len;
+
+        if (n > len)
+                n = len;
+
+        memcpy(&s->output[s->output_len], buf, n);
+        s->output_len += n;
+        return n;
+}
+
+static void update_session_events(struct session *s)
+{
+        struct epoll_event ev;
+
+        /* new input is not read until parser consumes the rest of previous one */
+        ev.events = ((s->input_pos < s->input_len) ? 0 : EPOLLIN) | ((s->output_pos < s->output_len) ? EPOLLOUT : 0);
+        if (ev.events == s->events)
+                return;
+
+        ev.data.u32 = s - sessions;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, s->fd, &ev);
+        s->events = ev.events;
+}
+
+static size_t flush_session(struct session *s)
+{
+        ssize_t n;
+
+        if (s->output_pos >= s->output_len)
+                return 0;
+
+        n = write(s->fd, &s->output[s->output_pos], s->output_len - s->output_pos);
+        if (n <= 0)
+                return 0;
+
+        s->output_pos += n;
+        if (s->output_pos >= s->output_len) {
+                s->output_pos = 0;
+                s->output_len = 0;
+        } else {
+                memmove(s->output, &s->output[s->output_pos], s->output_len - s->output_pos);
+                s->output_len -= s->output_pos;
+                s->output_pos = 0;
+        }
+
+        return n;
+}
+
+static void service_session(struct session *s)
+{
+        cat_wait_hint hint;
+        size_t flushed;
+
+        current_session = s;
+
+        /* parser runs until it waits for input, hold exit or output drained by EPOLLOUT */
+        do {
+                cat_service_run(&s->at, SERVICE_STEPS, NULL);
+                flushed = flush_session(s);
+                cat_get_wait_hint(&s->at, &hint);
+        } while ((hint == CAT_WAIT_HINT_NONE) || ((hint == CAT_WAIT_HINT_OUTPUT) && (flushed > 0)));
+
+        current_session = NULL;
+
+        update_session_events(s);
+}
+
+static void close_session(struct session *s)
+{
+        atomic_store(&s->active, false);
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, s->fd, NULL);
+        close(s->fd);
+        s->fd = -1;
+}
+
+static struct session* open_session(int fd, bool pty)
+{
+        struct cat_session_config config;
+        struct epoll_event ev;
+        struct session *s;
+        size_t i;
+
+        for (i = 0; i < SESSIONS_MAX; i++) {
+                if (sessions[i].fd < 0)
+                        break;
+        }
+        if (i >= SESSIONS_MAX)
+                return NULL;
+
+        s = &sessions[i];
+
+        /* ticker thread could still trigger event of previous session in this slot */
+        while (atomic_load(&ticker_pass) != false) {};
+
+        s->fd = fd;
+        s->pty = pty;
+        s->events = EPOLLIN;
+        s->input_pos = 0;
+        s->input_len = 0;
+        s->output_pos = 0;
+        s->output_len = 0;
+        atomic_store(&s->tick, false);
+        atomic_store(&s->kick, false);
+
+        memset(&s->iface, 0, sizeof(s->iface));
+        s->iface.ctx = s;
+        s->iface.read_ctx = session_read_char;
+        s->iface.write_block_ctx = session_write_block;
+
+        memset(&config, 0, sizeof(config));
+        config.buf = s->buf;
+        config.buf_size = sizeof(s->buf);
+        config.unsolicited_fsm = &s->unsolicited_fsm;
+        config.unsolicited_cmd_buf = s->unsolicited_cmd_buf;
+        config.unsolicited_cmd_buf_num = sizeof(s->unsolicited_cmd_buf) / sizeof(s->unsolicited_cmd_buf[0]);
+
+        cat_init_session(&s->at, &table, &config, &s->iface, NULL);
+
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+
+        atomic_store(&s->active, true);
+        return s;
+}
+
+static void read_session(struct session *s)
+{
+        ssize_t n;
+
+        /* rest of input is parsed before next read (backpressure for blocked output) */
+        if (s->input_pos < s->input_len)
+                return;
+
+        n = read(s->fd, s->input, sizeof(s->input));
+        if (n > 0) {
+                s->input_pos = 0;
+                s->input_len = n;
+                return;
+        }
+
+        if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR))) {
+                if (s->pty == false)
+                        close_session(s);
+        }
+}
+
+/* unsolicited events are triggered lock-free from other thread, epoll loop is woken by eventfd */
+static void trigger_session_event(struct session *s, struct cat_command const *cmd)
+{
+        uint64_t one = 1;
+
+        if (cat_trigger_unsolicited_read(&s->at, cmd) != CAT_STATUS_OK)
+                return;
+
+        atomic_store(&s->kick, true);
+        if (write(event_fd, &one, sizeof(one)) < 0)
+                return;
+}
+
+static void* ticker_thread(void *arg)
+{
+        size_t i;
+
+        (void)arg;
+
+        while (true) {
+                sleep(1);
+                atomic_fetch_add(&ticks, 1);
+
+                atomic_store(&ticker_pass, true);
+                for (i = 0; i < SESSIONS_MAX; i++) {
+                        if ((atomic_load(&sessions[i].active) != false) && (atomic_load(&sessions[i].tick) != false))
+                                trigger_session_event(&sessions[i], &cmds[1]);
+                }
+                atomic_store(&ticker_pass, false);
+        }
+
+        return NULL;
+}
+
+static void service_kicked_sessions(void)
+{
+        uint64_t cnt;
+        size_t i;
+
+        if (read(event_fd, &cnt, sizeof(cnt)) < 0)
+                return;
+
+        for (i = 0; i < SESSIONS_MAX; i++) {
+                if ((sessions[i].fd >= 0) && (atomic_exchange(&sessions[i].kick, false) != false))
+                        service_session(&sessions[i]);
+        }
+}
+
+static void accept_sessions(int listen_fd)
+{
+        int fd;
+
+        while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                if (open_session(fd, false) == NULL)
+                        close(fd);
+        }
+}
+
+static int open_listen_socket(const char *path)
+{
+        struct sockaddr_un addr;
+        int fd;
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+                return -1;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        unlink(path);
+
+        if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(fd, SOMAXCONN) != 0)) {
+                close(fd);
+                return -1;
+        }
+
+        return fd;
+}
+
+static int open_pty_session(void)
+{
+        struct termios tio;
+        int fd;
+        int slave_fd;
+
+        fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0))
+                return -1;
+
+        /* slave side is kept opened, so master is not hung up between terminal clients */
+        slave_fd = open(ptsname(fd), O_RDWR | O_NOCTTY);
+        if (slave_fd < 0)
+                return -1;
+
+        tcgetattr(slave_fd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(slave_fd, TCSANOW, &tio);
+
+        if (open_session(fd, true) == NULL)
+                return -1;
+
+        printf("session on %s\n", ptsname(fd));
+        return 0;
+}
+
+int main(int argc, char **argv)
+{
+        struct epoll_event events[EVENTS_NUM];
+        struct epoll_event ev;
+        pthread_t ticker;
+        int listen_fd;
+        int pty_num;
+        int n;
+        int i;
+        uint32_t tag;
+
+        if (argc < 2) {
+                fprintf(stderr, "usage: %s <socket path> [number of pseudo-terminals]\n", argv[0]);
+                return 1;
+        }
+        pty_num = (argc > 2) ? atoi(argv[2]) : 0;
+
+        for (i = 0; i < (int)SESSIONS_MAX; i++) {
+                sessions[i].fd = -1;
+                atomic_init(&sessions[i].active, false);
+                atomic_init(&sessions[i].tick, false);
+                atomic_init(&sessions[i].kick, false);
+        }
+
+        /* write to disconnected client fails with EPIPE instead of killing server */
+        signal(SIGPIPE, SIG_IGN);
+
+        /* commands table is built once for all sessions */
+        cat_table_init(&table, &desc);
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        listen_fd = open_listen_socket(argv[1]);
+        if ((epoll_fd < 0) || (event_fd < 0) || (listen_fd < 0)) {
+                perror("server");
+                return 1;
+        }
+
+        ev.events = EPOLLIN;
+        ev.data.u32 = TAG_LISTEN;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+        ev.data.u32 = TAG_EVENT;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev);
+
+        for (i = 0; i < pty_num; i++) {
+                if (open_pty_session() != 0) {
+                        perror("pty");
+                        return 1;
+                }
+        }
+
+        pthread_create(&ticker, NULL, ticker_thread, NULL);
+
+        printf("listening on %s\n", argv[1]);
+        fflush(stdout);
+
+        while (true) {
+                n = epoll_wait(epoll_fd, events, EVENTS_NUM, -1);
+                for (i = 0; i < n; i++) {
+                        tag = events[i].data.u32;
+                        if (tag == TAG_LISTEN) {
+                                accept_sessions(listen_fd);
+                        } else if (tag == TAG_EVENT) {
+                                service_kicked_sessions();
+                        } else if (sessions[tag].fd >= 0) {
+                                if (((events[i].events & (EPOLLHUP | EPOLLERR)) != 0) && (sessions[tag].pty == false)) {
+                                        close_session(&sessions[tag]);
+                                        continue;
+                                }
+                                if ((events[i].events & EPOLLIN) != 0)
+                                        read_session(&sessions[tag]);
+                                if (sessions[tag].fd >= 0)
+                                        service_session(&sessions[tag]);
+                        }
+                }
+        }
+
+        return 0;
+}
@@ -199,6 +199,9 @@ static struct cat_command cmds[] = {
 /* working buffer */
 static char buf[128];
 
+/* unsolicited events fsm storage */
+static struct cat_unsolicited_fsm unsolicited_fsm;
+
 /* declaring parser descriptor */
 static struct cat_command_group cmd_group = {
         .cmd = cmds,
@@ -215,6 +218,8 @@ static struct cat_descriptor desc = {
 
         .buf = buf,
         .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm
 };
 
 /* custom target dependent input output handlers */
@@ -36,24 +36,101 @@ SOFTWARE.
 #define CAT_WRITE_STATE_MAIN_BUFFER (1U)
 #define CAT_WRITE_STATE_AFTER (2U)
 
+/* completion cell sequence of token lap: free, pending (handler in progress or command in flight), claimed by worker, completed */
+#define CAT_ASYNC_SEQ_FREE(t) (4 * (t))
+#define CAT_ASYNC_SEQ_PENDING(t) (4 * (t) + 1)
+#define CAT_ASYNC_SEQ_CLAIMED(t) (4 * (t) + 2)
+#define CAT_ASYNC_SEQ_COMPLETED(t) (4 * (t) + 3)
+
 static inline char* get_atcmd_buf(struct cat_object *self)
 {
-        return (char*)self->desc->buf;
+        return (char*)self->buf;
 }
 
 static inline size_t get_atcmd_buf_size(struct cat_object *self)
 {
-        return (self->desc->unsolicited_buf != NULL) ? self->desc->buf_size : self->desc->buf_size >> 1;
+        return self->buf_size;
+}
+
+static inline char* get_unsolicited_base_buf(struct cat_object *self)
+{
+        return self->unsolicited_buf;
 }
 
+static inline size_t get_unsolicited_base_buf_size(struct cat_object *self)
+{
+        return self->unsolicited_buf_size;
+}
+
+/* currently formatted response is placed after already batched responses */
 static inline char* get_unsolicited_buf(struct cat_object *self)
 {
-        return (self->desc->unsolicited_buf != NULL) ? (char*)self->desc->unsolicited_buf : (char*)&self->desc->buf[self->desc->buf_size >> 1];
+        return &get_unsolicited_base_buf(self)[self->unsolicited_fsm->batch_offset];
 }
 
 static inline size_t get_unsolicited_buf_size(struct cat_object *self)
 {
-        return (self->desc->unsolicited_buf != NULL) ? self->desc->unsolicited_buf_size : self->desc->buf_size >> 1;
+        return get_unsolicited_base_buf_size(self) - self->unsolicited_fsm->batch_offset;
+}
+
+static inline struct cat_unsolicited_queue* get_unsolicited_queue(struct cat_object *self, cat_unsolicited_priority priority)
+{
+        return (self->unsolicited_fsm->queue[priority].buf != NULL) ? &self->unsolicited_fsm->queue[priority] : &self->unsolicited_fsm->queue[CAT_UNSOLICITED_PRIORITY_NORMAL];
+}
+
+static inline int lock_mutex(struct cat_object *self)
+{
+        return (self->mutex->lock_ctx != NULL) ? self->mutex->lock_ctx(self->mutex->ctx) : self->mutex->lock();
+}
+
+static inline int unlock_mutex(struct cat_object *self)
+{
+        return (self->mutex->unlock_ctx != NULL) ? self->mutex->unlock_ctx(self->mutex->ctx) : self->mutex->unlock();
+}
+
+static inline uint32_t get_clock_time_us(struct cat_object *self)
+{
+        return (self->clock->get_time_us_ctx != NULL) ? self->clock->get_time_us_ctx(self->clock->ctx) : self->clock->get_time_us();
+}
+
+static inline bool has_io_read_block(struct cat_io_interface const *io)
+{
+        return (io->read_block != NULL) || (io->read_block_ctx != NULL);
+}
+
+static inline bool has_io_write_block(struct cat_io_interface const *io)
+{
+        return (io->write_block != NULL) || (io->write_block_ctx != NULL);
+}
+
+static inline bool has_io_write_iov(struct cat_io_interface const *io)
+{
+        return (io->write_iov != NULL) || (io->write_iov_ctx != NULL);
+}
+
+static inline int io_write(struct cat_object *self, char ch)
+{
+        return (self->io->write_ctx != NULL) ? self->io->write_ctx(self->io->ctx, ch) : self->io->write(ch);
+}
+
+static inline int io_read(struct cat_object *self, char *ch)
+{
+        return (self->io->read_ctx != NULL) ? self->io->read_ctx(self->io->ctx, ch) : self->io->read(ch);
+}
+
+static inline size_t io_read_block(struct cat_object *self, char *buf, size_t max_size)
+{
+        return (self->io->read_block_ctx != NULL) ? self->io->read_block_ctx(self->io->ctx, buf, max_size) : self->io->read_block(buf, max_size);
+}
+
+static inline size_t io_write_block(struct cat_object *self, const char *buf, size_t len)
+{
+        return (self->io->write_block_ctx != NULL) ? self->io->write_block_ctx(self->io->ctx, buf, len) : self->io->write_block(buf, len);
+}
+
+static inline size_t io_write_iov(struct cat_object *self, const struct cat_io_vec *iov, size_t iov_num)
+{
+        return (self->io->write_iov_ctx != NULL) ? self->io->write_iov_ctx(self->io->ctx, iov, iov_num) : self->io->write_iov(iov, iov_num);
 }
 
 static char to_upper(char ch)
@@ -61,6 +138,31 @@ static char to_upper(char ch)
         return (ch >= 'a' && ch <= 'z') ? ch - ('a' - 'A') : ch;
 }
 
+uint32_t cat_hash_update(uint32_t hash, char ch)
+{
+        hash ^= (uint8_t)to_upper(ch);
+        return hash * 16777619U;
+}
+
+uint32_t cat_hash_mix(uint32_t hash, uint32_t seed)
+{
+        hash ^= seed * 0x9E3779B9U;
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6BU;
+        hash ^= hash >> 13;
+        hash *= 0xC2B2AE35U;
+        hash ^= hash >> 16;
+        return hash;
+}
+
+static size_t get_cmd_hash_index(struct cat_object *self, uint32_t name_hash)
+{
+        struct cat_command_hash const *cmd_hash = self->desc->cmd_hash;
+        uint32_t seed = cmd_hash->seed[name_hash % cmd_hash->seed_num];
+
+        return cmd_hash->index[cat_hash_mix(name_hash, seed) % cmd_hash->num];
+}
+
 static void reset_state(struct cat_object *self)
 {
         assert(self != NULL);
@@ -73,15 +175,19 @@ static void reset_state(struct cat_object *self)
         }
         self->cmd = NULL;
         self->cmd_type = CAT_CMD_TYPE_NONE;
+        self->args = NULL;
 }
 
 static void unsolicited_reset_state(struct cat_object *self)
 {
         assert(self != NULL);
 
-        self->unsolicited_fsm.cmd = NULL;
-        self->unsolicited_fsm.cmd_type = CAT_CMD_TYPE_NONE;
-        self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_IDLE;
+        self->unsolicited_fsm->cmd = NULL;
+        self->unsolicited_fsm->cmd_type = CAT_CMD_TYPE_NONE;
+        self->unsolicited_fsm->snapshot = false;
+        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_IDLE;
+        self->unsolicited_fsm->batch_len = 0;
+        self->unsolicited_fsm->batch_offset = 0;
 }
 
 static cat_status is_busy(struct cat_object *self)
@@ -95,12 +201,12 @@ cat_status cat_is_busy(struct cat_object *self)
 
         assert(self != NULL);
 
-        if ((self->mutex != NULL) && (self->mutex->lock() != 0))
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_LOCK;
 
         s = is_busy(self);
 
-        if ((self->mutex != NULL) && (self->mutex->unlock() != 0))
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_UNLOCK;
 
         return s;
@@ -117,12 +223,12 @@ cat_status cat_is_hold(struct cat_object *self)
 
         assert(self != NULL);
 
-        if ((self->mutex != NULL) && (self->mutex->lock() != 0))
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_LOCK;
 
         s = is_hold(self);
 
-        if ((self->mutex != NULL) && (self->mutex->unlock() != 0))
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_UNLOCK;
 
         return s;
@@ -150,83 +256,340 @@ static bool is_variables_access_possible(struct cat_object *self, const struct c
         return ok;
 }
 
+/*
+ * Unsolicited commands buffer is bounded lock-free multi-producer single-consumer queue.
+ * Producers reserve position by atomic increment of tail, then publish cell by its sequence number.
+ * Cell at position pos is free when its sequence is equal to 2 * pos, and ready when it is equal to 2 * pos + 1
+ * (doubled sequence keeps ready and free for next lap states distinct also for single cell buffer).
+ */
+static bool is_unsolicited_queue_full(struct cat_unsolicited_queue *queue)
+{
+        size_t tail;
+        size_t seq;
+
+        assert(queue != NULL);
+
+        tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        seq = atomic_load_explicit(&queue->buf[tail % queue->buf_num].sequence, memory_order_acquire);
+
+        /* cell at tail position still occupied by previous lap */
+        return ((ptrdiff_t)(seq - 2 * tail) < 0) ? true : false;
+}
+
+static size_t get_unsolicited_queue_depth(struct cat_unsolicited_queue *queue)
+{
+        size_t head;
+        size_t depth;
+
+        assert(queue != NULL);
+
+        /* head is loaded first, so depth cannot be negative */
+        head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        depth = atomic_load_explicit(&queue->tail, memory_order_acquire) - head;
+
+        /* reserved but not yet published cells are also counted */
+        return (depth > queue->buf_num) ? queue->buf_num : depth;
+}
+
 static bool is_unsolicited_buffer_full(struct cat_object *self)
 {
         assert(self != NULL);
 
-        return (self->unsolicited_fsm.unsolicited_cmd_buffer_items_count == CAT_UNSOLICITED_CMD_BUFFER_SIZE) ? true : false;
+        /* without fsm storage unsolicited buffer has no capacity */
+        if (self->unsolicited_fsm == NULL)
+                return true;
+
+        return is_unsolicited_queue_full(get_unsolicited_queue(self, CAT_UNSOLICITED_PRIORITY_NORMAL));
 }
 
 static bool is_unsolicited_buffer_empty(struct cat_object *self)
 {
+        size_t i;
+
         assert(self != NULL);
 
-        return (self->unsolicited_fsm.unsolicited_cmd_buffer_items_count == 0) ? true : false;
+        if (self->unsolicited_fsm == NULL)
+                return true;
+
+        for (i = 0; i < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM; i++) {
+                if ((self->unsolicited_fsm->queue[i].buf != NULL) && (get_unsolicited_queue_depth(&self->unsolicited_fsm->queue[i]) > 0))
+                        return false;
+        }
+
+        return true;
 }
 
-static cat_status pop_unsolicited_cmd(struct cat_object *self, struct cat_command const **cmd, cat_cmd_type *type)
+static inline size_t get_cmd_addr_hash(struct cat_object *self, struct cat_command const *cmd)
 {
-        struct cat_unsolicited_cmd *item;
+        return (size_t)(((uintptr_t)cmd / sizeof(struct cat_command)) * 2654435761U) & (self->desc->cmd_addr_index_num - 1);
+}
+
+static bool get_cmd_index_by_addr(struct cat_object *self, struct cat_command const *cmd, size_t *index)
+{
+        size_t pos = get_cmd_addr_hash(self, cmd);
+        struct cat_command_index const *cmd_addr_index = self->desc->cmd_addr_index;
+
+        while (cmd_addr_index[pos].cmd != NULL) {
+                if (cmd_addr_index[pos].cmd == cmd) {
+                        *index = cmd_addr_index[pos].index;
+                        return true;
+                }
+                pos = (pos + 1) & (self->desc->cmd_addr_index_num - 1);
+        }
+
+        return false;
+}
+
+static bool get_unsolicited_pending_bit(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type, cat_unsolicited_priority priority, size_t *bit)
+{
+        size_t index;
 
         assert(self != NULL);
         assert(cmd != NULL);
+        assert(bit != NULL);
+
+        if (self->unsolicited_pending_buf == NULL)
+                return false;
+
+        /* global command index is resolved from command address in constant time */
+        if (get_cmd_index_by_addr(self, cmd, &index) == false)
+                return false;
+
+        /* events are coalesced only within the same queue, so merged event is never delayed by lower priority */
+        priority = get_unsolicited_queue(self, priority) - self->unsolicited_fsm->queue;
+
+        *bit = ((index << 1) + ((type == CAT_CMD_TYPE_TEST) ? 1 : 0)) * CAT_UNSOLICITED_PRIORITY__TOTAL_NUM + priority;
+        return true;
+}
+
+static bool is_unsolicited_pending(struct cat_object *self, size_t bit)
+{
+        return ((atomic_load_explicit(&self->unsolicited_pending_buf[bit >> 3], memory_order_acquire) >> (bit & 0x07)) & 0x01) != 0;
+}
+
+static bool set_unsolicited_pending(struct cat_object *self, size_t bit)
+{
+        unsigned char mask = 1U << (bit & 0x07);
+
+        /* returns previous state of pending flag */
+        return (atomic_fetch_or_explicit(&self->unsolicited_pending_buf[bit >> 3], mask, memory_order_acq_rel) & mask) != 0;
+}
+
+static void clear_unsolicited_pending(struct cat_object *self, size_t bit)
+{
+        unsigned char mask = 1U << (bit & 0x07);
+
+        atomic_fetch_and_explicit(&self->unsolicited_pending_buf[bit >> 3], (unsigned char)~mask, memory_order_release);
+}
+
+/* payload slots of queues are placed one after another in queue priority order */
+static size_t get_unsolicited_arena_slots_num(struct cat_object *self)
+{
+        size_t i;
+        size_t n = 0;
+
+        for (i = 0; i < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM; i++)
+                n += self->unsolicited_fsm->queue[i].buf_num;
+
+        return n;
+}
+
+static inline char* get_unsolicited_queue_slot(struct cat_object *self, struct cat_unsolicited_queue *queue, size_t pos)
+{
+        struct cat_unsolicited_queue *q;
+        size_t slot = pos % queue->buf_num;
+
+        for (q = self->unsolicited_fsm->queue; q != queue; q++)
+                slot += q->buf_num;
+
+        return &self->unsolicited_fsm->arena[slot * self->unsolicited_fsm->arena_slot_size];
+}
+
+static cat_status pop_unsolicited_queue_cmd(struct cat_object *self, struct cat_unsolicited_queue *queue, struct cat_command const **cmd, cat_cmd_type *type, bool *snapshot)
+{
+        struct cat_unsolicited_cmd *item;
+        size_t head;
+        char *slot;
+        size_t len;
+
+        assert(queue != NULL);
+        assert(cmd != NULL);
         assert(type != NULL);
+        assert(snapshot != NULL);
+
+        while (true) {
+                head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+                item = &queue->buf[head % queue->buf_num];
+
+                if (atomic_load_explicit(&item->sequence, memory_order_acquire) != 2 * head + 1)
+                        return CAT_STATUS_ERROR_BUFFER_EMPTY;
 
-        if (is_unsolicited_buffer_empty(self) != false)
-                return CAT_STATUS_ERROR_BUFFER_EMPTY;
+                if (item->skip == false)
+                        break;
+
+                /* cell carries no event (snapshot not formatted), so it is only released */
+                atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+                atomic_store_explicit(&item->sequence, 2 * (head + queue->buf_num), memory_order_release);
+        }
 
-        item = &self->unsolicited_fsm.unsolicited_cmd_buffer[self->unsolicited_fsm.unsolicited_cmd_buffer_head];
+        if (item->snapshot != false) {
+                /* snapshot response is left in queue until it fits into unsolicited buffer */
+                slot = get_unsolicited_queue_slot(self, queue, head);
+                len = strlen(slot);
+                if (len >= get_unsolicited_buf_size(self))
+                        return CAT_STATUS_ERROR_BUFFER_FULL;
+                memcpy(get_unsolicited_buf(self), slot, len + 1);
+        }
 
         *cmd = item->cmd;
         *type = item->type;
+        *snapshot = item->snapshot;
 
-        if (++self->unsolicited_fsm.unsolicited_cmd_buffer_head >= CAT_UNSOLICITED_CMD_BUFFER_SIZE)
-                self->unsolicited_fsm.unsolicited_cmd_buffer_head = 0;
+        /* event triggered from now on is buffered again, because processing result could be outdated */
+        if (item->pending_bit != 0)
+                clear_unsolicited_pending(self, item->pending_bit - 1);
 
-        self->unsolicited_fsm.unsolicited_cmd_buffer_items_count--;
+        atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+        /* release cell for producers of next lap */
+        atomic_store_explicit(&item->sequence, 2 * (head + queue->buf_num), memory_order_release);
 
         return CAT_STATUS_OK;
 }
 
-static cat_status push_unsolicited_cmd(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type)
+static cat_status pop_unsolicited_cmd(struct cat_object *self, struct cat_command const **cmd, cat_cmd_type *type, bool *snapshot)
 {
+        size_t i;
+        struct cat_unsolicited_queue *queue;
+        cat_status s;
+
+        assert(self != NULL);
+
+        /* highest non-empty priority queue is always drained first */
+        for (i = CAT_UNSOLICITED_PRIORITY__TOTAL_NUM; i > 0; i--) {
+                queue = &self->unsolicited_fsm->queue[i - 1];
+                if (queue->buf == NULL)
+                        continue;
+
+                s = pop_unsolicited_queue_cmd(self, queue, cmd, type, snapshot);
+                if (s != CAT_STATUS_ERROR_BUFFER_EMPTY)
+                        return s;
+        }
+
+        return CAT_STATUS_ERROR_BUFFER_EMPTY;
+}
+
+static void update_unsolicited_queue_high_water_mark(struct cat_unsolicited_queue *queue)
+{
+        size_t depth = get_unsolicited_queue_depth(queue);
+        size_t hwm = atomic_load_explicit(&queue->high_water_mark, memory_order_relaxed);
+
+        /* on failure hwm is reloaded with actual value */
+        while ((depth > hwm) && (atomic_compare_exchange_weak_explicit(&queue->high_water_mark, &hwm, depth, memory_order_relaxed, memory_order_relaxed) == false)) {};
+}
+
+static struct cat_unsolicited_cmd* reserve_unsolicited_cell(struct cat_object *self, struct cat_unsolicited_queue *queue, size_t *pos)
+{
+        struct cat_unsolicited_cmd *item;
+        size_t tail;
+        size_t seq;
+
+        assert(self != NULL);
+        assert(queue != NULL);
+        assert(pos != NULL);
+
+        tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        while (true) {
+                item = &queue->buf[tail % queue->buf_num];
+                seq = atomic_load_explicit(&item->sequence, memory_order_acquire);
+
+                if (seq == 2 * tail) {
+                        /* on failure tail is reloaded with actual value */
+                        if (atomic_compare_exchange_weak_explicit(&queue->tail, &tail, tail + 1, memory_order_relaxed, memory_order_relaxed) != false)
+                                break;
+                } else if ((ptrdiff_t)(seq - 2 * tail) < 0) {
+                        /* cell is still occupied by previous lap */
+                        atomic_fetch_add_explicit(&self->unsolicited_fsm->dropped_cntr, 1, memory_order_relaxed);
+                        return NULL;
+                } else {
+                        tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+                }
+        }
+
+        *pos = tail;
+        return item;
+}
+
+static void publish_unsolicited_cell(struct cat_unsolicited_queue *queue, struct cat_unsolicited_cmd *item, size_t pos)
+{
+        assert(queue != NULL);
+        assert(item != NULL);
+
+        atomic_store_explicit(&item->sequence, 2 * pos + 1, memory_order_release);
+
+        update_unsolicited_queue_high_water_mark(queue);
+}
+
+static cat_status push_unsolicited_cmd(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type, cat_unsolicited_priority priority, const char *args, size_t pending_bit)
+{
+        struct cat_unsolicited_queue *queue;
         struct cat_unsolicited_cmd *item;
+        size_t tail;
+        char *slot;
 
         assert(self != NULL);
         assert(cmd != NULL);
         assert(((type == CAT_CMD_TYPE_READ) || (type == CAT_CMD_TYPE_TEST)));
+        assert(priority < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM);
 
-        if (is_unsolicited_buffer_full(self) != false)
+        if (self->unsolicited_fsm == NULL)
                 return CAT_STATUS_ERROR_BUFFER_FULL;
 
-        item = &self->unsolicited_fsm.unsolicited_cmd_buffer[self->unsolicited_fsm.unsolicited_cmd_buffer_tail];
+        queue = get_unsolicited_queue(self, priority);
+
+        if (args != NULL) {
+                assert(self->unsolicited_fsm->arena != NULL);
+
+                /* name, equal sign, arguments and terminator */
+                if (strlen(cmd->name) + strlen(args) + 2 > self->unsolicited_fsm->arena_slot_size)
+                        return CAT_STATUS_ERROR;
+        }
+
+        /* pending flag is claimed before cell is reserved, so concurrent identical event never takes queue cell */
+        if ((pending_bit != 0) && (set_unsolicited_pending(self, pending_bit - 1) != false))
+                return CAT_STATUS_OK;
+
+        item = reserve_unsolicited_cell(self, queue, &tail);
+        if (item == NULL) {
+                /* identical event merged meanwhile into this one is dropped together with it */
+                if (pending_bit != 0)
+                        clear_unsolicited_pending(self, pending_bit - 1);
+                return CAT_STATUS_ERROR_BUFFER_FULL;
+        }
 
         item->cmd = cmd;
         item->type = type;
+        item->snapshot = (args != NULL);
+        item->pending_bit = pending_bit;
+        item->skip = false;
+
+        if (args != NULL) {
+                /* slot is owned by producer until cell is published */
+                slot = get_unsolicited_queue_slot(self, queue, tail);
+                strcpy(slot, cmd->name);
+                strcat(slot, "=");
+                strcat(slot, args);
+        }
 
-        if (++self->unsolicited_fsm.unsolicited_cmd_buffer_tail >= CAT_UNSOLICITED_CMD_BUFFER_SIZE)
-                self->unsolicited_fsm.unsolicited_cmd_buffer_tail = 0;
-
-        self->unsolicited_fsm.unsolicited_cmd_buffer_items_count++;
+        publish_unsolicited_cell(queue, item, tail);
 
         return CAT_STATUS_OK;
 }
 
 cat_status cat_is_unsolicited_buffer_full(struct cat_object *self)
 {
-        bool s;
-
         assert(self != NULL);
 
-        if ((self->mutex != NULL) && (self->mutex->lock() != 0))
-                return CAT_STATUS_ERROR_MUTEX_LOCK;
-
-        s = is_unsolicited_buffer_full(self);
-
-        if ((self->mutex != NULL) && (self->mutex->unlock() != 0))
-                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
-
-        return (s != false) ? CAT_STATUS_ERROR_BUFFER_FULL : CAT_STATUS_OK;
+        return (is_unsolicited_buffer_full(self) != false) ? CAT_STATUS_ERROR_BUFFER_FULL : CAT_STATUS_OK;
 }
 
 static struct cat_command* get_command_by_fsm(struct cat_object *self, cat_fsm_type fsm)
@@ -238,7 +601,7 @@ static struct cat_command* get_command_by_fsm(struct cat_object *self, cat_fsm_t
         case CAT_FSM_TYPE_ATCMD:
                 return (struct cat_command*)self->cmd;
         case CAT_FSM_TYPE_UNSOLICITED:
-                return (struct cat_command*)self->unsolicited_fsm.cmd;
+                return (self->unsolicited_fsm != NULL) ? (struct cat_command*)self->unsolicited_fsm->cmd : NULL;
         default:
                 assert(false);
         }
@@ -260,22 +623,49 @@ cat_status cat_is_unsolicited_event_buffered(struct cat_object *self, struct cat
         assert(cmd != NULL);
         assert(type < CAT_CMD_TYPE__TOTAL_NUM);
 
-        size_t num = self->unsolicited_fsm.unsolicited_cmd_buffer_items_count;
-        size_t index = self->unsolicited_fsm.unsolicited_cmd_buffer_head;
+        size_t index;
+        size_t tail;
+        size_t i;
         cat_status ret = CAT_STATUS_OK;
+        struct cat_unsolicited_queue *queue;
         struct cat_unsolicited_cmd *item;
+        size_t bit;
+
+        if (self->unsolicited_fsm == NULL)
+                return CAT_STATUS_OK;
 
-        if ((self->unsolicited_fsm.cmd == cmd) && ((type == CAT_CMD_TYPE_NONE) || (self->unsolicited_fsm.cmd_type == type)))
+        if ((self->unsolicited_fsm->cmd == cmd) && ((type == CAT_CMD_TYPE_NONE) || (self->unsolicited_fsm->cmd_type == type)))
                 ret =  CAT_STATUS_BUSY;
 
-        while ((num > 0) && (ret == CAT_STATUS_OK)) {
-                item = &self->unsolicited_fsm.unsolicited_cmd_buffer[index];
-                if ((item->cmd == cmd) && ((type == CAT_CMD_TYPE_NONE) || (item->type == type)))
-                        ret = CAT_STATUS_BUSY;
+        /* pending events bitmap replaces buffer scanning */
+        if ((ret == CAT_STATUS_OK) && (get_unsolicited_pending_bit(self, cmd, CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_LOW, &bit) != false)) {
+                bit -= bit % CAT_UNSOLICITED_PRIORITY__TOTAL_NUM;
+                for (i = 0; i < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM; i++) {
+                        if (((type == CAT_CMD_TYPE_NONE) || (type == CAT_CMD_TYPE_READ)) && (is_unsolicited_pending(self, bit + i) != false))
+                                ret = CAT_STATUS_BUSY;
+                        if (((type == CAT_CMD_TYPE_NONE) || (type == CAT_CMD_TYPE_TEST)) && (is_unsolicited_pending(self, bit + CAT_UNSOLICITED_PRIORITY__TOTAL_NUM + i) != false))
+                                ret = CAT_STATUS_BUSY;
+                }
+                return ret;
+        }
+
+        for (i = 0; (i < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM) && (ret == CAT_STATUS_OK); i++) {
+                queue = &self->unsolicited_fsm->queue[i];
+                if (queue->buf == NULL)
+                        continue;
+
+                index = atomic_load_explicit(&queue->head, memory_order_acquire);
+                tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
 
-                --num;
-                if (++index >= CAT_UNSOLICITED_CMD_BUFFER_SIZE)
-                        index = 0;
+                while ((index != tail) && (ret == CAT_STATUS_OK)) {
+                        item = &queue->buf[index % queue->buf_num];
+                        /* only published cells are checked */
+                        if ((atomic_load_explicit(&item->sequence, memory_order_acquire) == 2 * index + 1) && (item->skip == false) &&
+                            (item->cmd == cmd) && ((type == CAT_CMD_TYPE_NONE) || (item->type == type)))
+                                ret = CAT_STATUS_BUSY;
+
+                        index++;
+                }
         }
 
         return ret;
@@ -298,15 +688,37 @@ static void start_flush_io_buffer(struct cat_object *self, cat_state state_after
         self->state = CAT_STATE_FLUSH_IO_WRITE_WAIT;
 }
 
+static void unsolicited_start_flush_batch(struct cat_object *self, cat_unsolicited_state state_after)
+{
+        assert(self != NULL);
+
+        /* whole buffer with all batched responses is flushed */
+        self->unsolicited_fsm->batch_len = 0;
+        self->unsolicited_fsm->batch_offset = 0;
+
+        self->unsolicited_fsm->position = 0;
+        self->unsolicited_fsm->write_buf = get_new_line_chars(self);
+        self->unsolicited_fsm->write_state = CAT_WRITE_STATE_BEFORE;
+        self->unsolicited_fsm->write_state_after = state_after;
+        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE_WAIT;
+}
+
 static void unsolicited_start_flush_io_buffer(struct cat_object *self, cat_unsolicited_state state_after)
 {
         assert(self != NULL);
 
-        self->unsolicited_fsm.position = 0;
-        self->unsolicited_fsm.write_buf = get_new_line_chars(self);
-        self->unsolicited_fsm.write_state = CAT_WRITE_STATE_BEFORE;
-        self->unsolicited_fsm.write_state_after = state_after;
-        self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE_WAIT;
+        if ((state_after == CAT_UNSOLICITED_STATE_AFTER_FLUSH_OK) && (self->desc->unsolicited_batch != false)) {
+                self->unsolicited_fsm->batch_len = self->unsolicited_fsm->batch_offset + strlen(get_unsolicited_buf(self));
+
+                /* flush is postponed while next event can be formatted after separating new lines */
+                if ((is_unsolicited_buffer_empty(self) == false) &&
+                    (self->unsolicited_fsm->batch_len + 2 * strlen(get_new_line_chars(self)) < get_unsolicited_base_buf_size(self))) {
+                        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_BATCH_NEXT_EVENT;
+                        return;
+                }
+        }
+
+        unsolicited_start_flush_batch(self, state_after);
 }
 
 static void start_flush_io_buffer_raw(struct cat_object *self, cat_state state_after)
@@ -345,7 +757,7 @@ static size_t get_left_buffer_space_by_fsm(struct cat_object *self, cat_fsm_type
         case CAT_FSM_TYPE_ATCMD:
                 return get_atcmd_buf_size(self) - self->position;
         case CAT_FSM_TYPE_UNSOLICITED:
-                return get_unsolicited_buf_size(self) - self->unsolicited_fsm.position;
+                return get_unsolicited_buf_size(self) - self->unsolicited_fsm->position;
         default:
                 assert(false);
         }
@@ -362,7 +774,7 @@ static char* get_current_buffer_by_fsm(struct cat_object *self, cat_fsm_type fsm
         case CAT_FSM_TYPE_ATCMD:
                 return &(get_atcmd_buf(self)[self->position]);
         case CAT_FSM_TYPE_UNSOLICITED:
-                return &(get_unsolicited_buf(self)[self->unsolicited_fsm.position]);
+                return &(get_unsolicited_buf(self)[self->unsolicited_fsm->position]);
         default:
                 assert(false);
         }
@@ -380,7 +792,7 @@ static void move_position_by_fsm(struct cat_object *self, size_t offset, cat_fsm
                 self->position += offset;
                 break;
         case CAT_FSM_TYPE_UNSOLICITED:
-                self->unsolicited_fsm.position += offset;
+                self->unsolicited_fsm->position += offset;
                 break;
         default:
                 assert(false);
@@ -406,11 +818,117 @@ static int print_string_to_buf(struct cat_object *self, const char *str, cat_fsm
         return print_nstring_to_buf(self, str, strlen(str), fsm);
 }
 
+static int read_input_ring_char(struct cat_object *self, char *ch)
+{
+        if (self->ring_tail_local == self->ring_head_cache) {
+                /* consumed chars are released to producer only when cached chars run out */
+                atomic_store_explicit(&self->ring_tail, self->ring_tail_local, memory_order_release);
+                self->ring_head_cache = atomic_load_explicit(&self->ring_head, memory_order_acquire);
+                if (self->ring_tail_local == self->ring_head_cache)
+                        return 0;
+        }
+
+        *ch = self->input_ring_buf[self->ring_tail_local & (self->input_ring_size - 1)];
+        self->ring_tail_local++;
+        return 1;
+}
+
+size_t cat_feed_input(struct cat_object *self, const char *buf, size_t len)
+{
+        size_t head, tail, size, n, i;
+
+        assert(self != NULL);
+        assert(buf != NULL);
+        assert(self->input_ring_buf != NULL);
+
+        size = self->input_ring_size;
+        head = atomic_load_explicit(&self->ring_head, memory_order_relaxed);
+        tail = atomic_load_explicit(&self->ring_tail, memory_order_acquire);
+
+        n = size - (head - tail);
+        if (n > len)
+                n = len;
+
+        /* ring is split into at most two continuous parts */
+        i = head & (size - 1);
+        if (i + n <= size) {
+                memcpy(&self->input_ring_buf[i], buf, n);
+        } else {
+                memcpy(&self->input_ring_buf[i], buf, size - i);
+                memcpy(self->input_ring_buf, &buf[size - i], n - (size - i));
+        }
+
+        atomic_store_explicit(&self->ring_head, head + n, memory_order_release);
+        return n;
+}
+
+static bool is_line_consumed(struct cat_object *self)
+{
+        /* implicit new line char after last line char is also consumed */
+        return self->line_pos > self->line_len;
+}
+
+static void release_line(struct cat_object *self)
+{
+        /* line is owned by parser until all its commands are parsed and answered */
+        if ((self->line != NULL) && (is_line_consumed(self) != false) &&
+            ((self->state == CAT_STATE_IDLE) || (self->state == CAT_STATE_HOLD)))
+                self->line = NULL;
+}
+
+static int read_input_char(struct cat_object *self, char *ch)
+{
+        if (self->line != NULL) {
+                if (self->line_pos > self->line_len)
+                        return 0;
+                /* processed line is always terminated by implicit new line char */
+                *ch = (self->line_pos < self->line_len) ? self->line[self->line_pos] : '\n';
+                self->line_pos++;
+                return 1;
+        }
+
+        if (self->input_ring_buf != NULL)
+                return read_input_ring_char(self, ch);
+
+        if (has_io_read_block(self->io) == false)
+                return io_read(self, ch);
+
+        if (self->input_pos >= self->input_len) {
+                self->input_pos = 0;
+                self->input_len = io_read_block(self, self->input_buf, self->input_buf_size);
+                assert(self->input_len <= self->input_buf_size);
+                if (self->input_len == 0)
+                        return 0;
+        }
+
+        *ch = self->input_buf[self->input_pos++];
+        return 1;
+}
+
+static int read_input_char_cntr(struct cat_object *self, char *ch)
+{
+        if (read_input_char(self, ch) == 0) {
+                self->input_empty_flag = true;
+                return 0;
+        }
+
+        self->read_cntr++;
+        return 1;
+}
+
+static bool is_input_staged(struct cat_object *self)
+{
+        if (self->input_ring_buf != NULL)
+                return self->ring_tail_local != self->ring_head_cache;
+
+        return self->input_pos < self->input_len;
+}
+
 static int read_cmd_char(struct cat_object *self)
 {
         assert(self != NULL);
 
-        if (self->io->read(&self->current_char) == 0)
+        if (read_input_char_cntr(self, &self->current_char) == 0)
                 return 0;
 
         if (self->state != CAT_STATE_PARSE_COMMAND_ARGS)
@@ -427,6 +945,9 @@ static struct cat_command const* get_command_by_index(struct cat_object *self, s
         assert(self != NULL);
         assert(index < self->commands_num);
 
+        if (self->desc->cmd_table != NULL)
+                return self->desc->cmd_table[index];
+
         j = 0;
         for (i = 0; i < self->desc->cmd_group_num; i++) {
                 cmd_group = self->desc->cmd_group[i];
@@ -442,26 +963,261 @@ static struct cat_command const* get_command_by_index(struct cat_object *self, s
         return NULL;
 }
 
-static void unsolicited_init(struct cat_object *self)
+static void build_cmd_table(struct cat_object *self)
 {
-        self->unsolicited_fsm.unsolicited_cmd_buffer_tail = 0;
-        self->unsolicited_fsm.unsolicited_cmd_buffer_head = 0;
-        self->unsolicited_fsm.unsolicited_cmd_buffer_items_count = 0;
+        size_t i, j, n;
+        struct cat_command_group const *cmd_group;
 
-        unsolicited_reset_state(self);
+        assert(self != NULL);
+        assert(self->desc->cmd_table_num >= self->commands_num);
+
+        n = 0;
+        for (i = 0; i < self->desc->cmd_group_num; i++) {
+                cmd_group = self->desc->cmd_group[i];
+                for (j = 0; j < cmd_group->cmd_num; j++)
+                        self->desc->cmd_table[n++] = &cmd_group->cmd[j];
+        }
 }
 
-void cat_init(struct cat_object *self, const struct cat_descriptor *desc, const struct cat_io_interface *io, const struct cat_mutex_interface *mutex)
+static void build_cmd_addr_index(struct cat_object *self)
 {
-        size_t i, j;
+        size_t i, j, n, pos;
         struct cat_command_group const *cmd_group;
+        struct cat_command_index *cmd_addr_index = self->desc->cmd_addr_index;
 
         assert(self != NULL);
-        assert(desc != NULL);
-        assert(io != NULL);
+        assert((self->desc->cmd_addr_index_num & (self->desc->cmd_addr_index_num - 1)) == 0);
+        assert(self->desc->cmd_addr_index_num >= 2 * self->commands_num);
 
-        assert(desc->cmd_group != NULL);
-        assert(desc->cmd_group_num > 0);
+        for (i = 0; i < self->desc->cmd_addr_index_num; i++)
+                cmd_addr_index[i].cmd = NULL;
+
+        /* open addressing with linear probing, at most half of entries is used */
+        n = 0;
+        for (i = 0; i < self->desc->cmd_group_num; i++) {
+                cmd_group = self->desc->cmd_group[i];
+                for (j = 0; j < cmd_group->cmd_num; j++) {
+                        pos = get_cmd_addr_hash(self, &cmd_group->cmd[j]);
+                        while (cmd_addr_index[pos].cmd != NULL)
+                                pos = (pos + 1) & (self->desc->cmd_addr_index_num - 1);
+                        cmd_addr_index[pos].cmd = &cmd_group->cmd[j];
+                        cmd_addr_index[pos].index = n++;
+                }
+        }
+}
+
+static void update_cmd_disable_bitmap(struct cat_object *self)
+{
+        size_t i, j, n;
+        struct cat_command_group const *cmd_group;
+        uint8_t *bitmap = self->desc->cmd_disable_buf;
+
+        assert(self != NULL);
+        assert(self->desc->cmd_disable_buf_size * 8U >= self->commands_num);
+
+        memset(bitmap, 0, self->desc->cmd_disable_buf_size);
+
+        n = 0;
+        for (i = 0; i < self->desc->cmd_group_num; i++) {
+                cmd_group = self->desc->cmd_group[i];
+                for (j = 0; j < cmd_group->cmd_num; j++, n++) {
+                        if ((cmd_group->disable != false) || (cmd_group->cmd[j].disable != false))
+                                bitmap[n >> 3] |= 1U << (n & 0x07);
+                }
+        }
+}
+
+cat_status cat_update_disable_state(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        if (self->desc->cmd_disable_buf != NULL)
+                update_cmd_disable_bitmap(self);
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return CAT_STATUS_OK;
+}
+
+static void build_cmd_meta(struct cat_object *self)
+{
+        size_t i, n;
+        struct cat_command const *cmd;
+        struct cat_command_meta *meta;
+        char *name;
+
+        assert(self != NULL);
+        assert(self->desc->cmd_meta_num >= self->commands_num);
+        assert((self->desc->cmd_name_buf != NULL) || (self->desc->cmd_hash != NULL));
+
+        name = self->desc->cmd_name_buf;
+        for (i = 0; i < self->commands_num; i++) {
+                cmd = get_command_by_index(self, i);
+                meta = &self->desc->cmd_meta[i];
+
+                meta->name_len = strlen(cmd->name);
+
+                if (self->desc->cmd_name_buf == NULL) {
+                        meta->name = self->desc->cmd_hash->name[i];
+                } else {
+                        assert(name + meta->name_len < self->desc->cmd_name_buf + self->desc->cmd_name_buf_size);
+
+                        for (n = 0; n < meta->name_len; n++)
+                                name[n] = to_upper(cmd->name[n]);
+                        name[n] = '\0';
+
+                        meta->name = name;
+                        name += meta->name_len + 1;
+                }
+
+                meta->first_char = meta->name[0];
+        }
+}
+
+static int compare_cmd_names(const char *name1, const char *name2)
+{
+        char ch1, ch2;
+
+        do {
+                ch1 = to_upper(*name1++);
+                ch2 = to_upper(*name2++);
+        } while ((ch1 == ch2) && (ch1 != '\0'));
+
+        return (int)(uint8_t)ch1 - (int)(uint8_t)ch2;
+}
+
+static void build_cmd_index(struct cat_object *self)
+{
+        size_t i, pos, lo, hi, mid;
+        struct cat_command_index *cmd_index = self->desc->cmd_index;
+        struct cat_command const *cmd;
+
+        assert(self != NULL);
+        assert(self->desc->cmd_index_num >= self->commands_num);
+
+        /* binary insertion sort (stable, so equal names stay in registration order) */
+        for (i = 0; i < self->commands_num; i++) {
+                cmd = get_command_by_index(self, i);
+
+                lo = 0;
+                hi = i;
+                while (lo < hi) {
+                        mid = lo + ((hi - lo) >> 1);
+                        if (compare_cmd_names(cmd->name, cmd_index[mid].cmd->name) < 0) {
+                                hi = mid;
+                        } else {
+                                lo = mid + 1;
+                        }
+                }
+                pos = lo;
+
+                memmove(&cmd_index[pos + 1], &cmd_index[pos], (i - pos) * sizeof(cmd_index[0]));
+                cmd_index[pos].cmd = cmd;
+                cmd_index[pos].index = i;
+        }
+
+        for (i = 0; i < self->commands_num; i++) {
+                if (cmd_index[i].index == self->commands_num - 1) {
+                        self->cmd_index_last = i;
+                        break;
+                }
+        }
+}
+
+static void unsolicited_queue_init(struct cat_unsolicited_queue *queue, struct cat_unsolicited_cmd *buf, size_t buf_num)
+{
+        size_t i;
+
+        assert((buf == NULL) || (buf_num > 0));
+
+        queue->buf = buf;
+        queue->buf_num = (buf != NULL) ? buf_num : 0;
+
+        for (i = 0; i < queue->buf_num; i++)
+                atomic_init(&buf[i].sequence, 2 * i);
+
+        atomic_init(&queue->tail, 0);
+        atomic_init(&queue->head, 0);
+        atomic_init(&queue->high_water_mark, 0);
+}
+
+static void unsolicited_init(struct cat_object *self, const struct cat_session_config *config)
+{
+        self->unsolicited_fsm = config->unsolicited_fsm;
+        if (config->unsolicited_fsm == NULL) {
+                /* unsolicited buffers are useless without fsm storage */
+                assert(config->unsolicited_cmd_buf == NULL);
+                assert(config->unsolicited_low_cmd_buf == NULL);
+                assert(config->unsolicited_high_cmd_buf == NULL);
+                assert(config->unsolicited_arena_buf == NULL);
+                assert(config->unsolicited_pending_buf == NULL);
+                return;
+        }
+
+        self->unsolicited_fsm->rate_credit = 0;
+        self->unsolicited_fsm->rate_time_us = 0;
+        self->unsolicited_fsm->rate_time_valid = false;
+        self->unsolicited_fsm->rate_deferred = false;
+        self->unsolicited_fsm->deferred_cntr = 0;
+        atomic_init(&self->unsolicited_fsm->dropped_cntr, 0);
+
+        self->unsolicited_fsm->arena = config->unsolicited_arena_buf;
+        self->unsolicited_fsm->arena_slot_size = 0;
+        if (config->unsolicited_arena_buf != NULL) {
+                assert(config->unsolicited_arena_slot_size > 0);
+                assert(config->unsolicited_arena_slot_size <= get_unsolicited_base_buf_size(self));
+                self->unsolicited_fsm->arena_slot_size = config->unsolicited_arena_slot_size;
+        }
+
+        if (config->unsolicited_cmd_buf != NULL) {
+                unsolicited_queue_init(&self->unsolicited_fsm->queue[CAT_UNSOLICITED_PRIORITY_NORMAL], config->unsolicited_cmd_buf, config->unsolicited_cmd_buf_num);
+        } else {
+                unsolicited_queue_init(&self->unsolicited_fsm->queue[CAT_UNSOLICITED_PRIORITY_NORMAL], self->unsolicited_fsm->unsolicited_cmd_buffer, CAT_UNSOLICITED_CMD_BUFFER_SIZE);
+        }
+
+        unsolicited_queue_init(&self->unsolicited_fsm->queue[CAT_UNSOLICITED_PRIORITY_LOW], config->unsolicited_low_cmd_buf, config->unsolicited_low_cmd_buf_num);
+        unsolicited_queue_init(&self->unsolicited_fsm->queue[CAT_UNSOLICITED_PRIORITY_HIGH], config->unsolicited_high_cmd_buf, config->unsolicited_high_cmd_buf_num);
+
+        /* every queue item owns one payload slot, so snapshot cannot be overwritten before it is flushed */
+        assert((config->unsolicited_arena_buf == NULL) ||
+               (config->unsolicited_arena_buf_size >= get_unsolicited_arena_slots_num(self) * config->unsolicited_arena_slot_size));
+
+        unsolicited_reset_state(self);
+}
+
+static void check_cmd_hash(struct cat_object *self)
+{
+        struct cat_command_hash const *cmd_hash = self->desc->cmd_hash;
+        struct cat_command const *cmd;
+        uint32_t hash;
+        size_t i, j;
+
+        assert(self != NULL);
+
+        /* every command has to be resolved from its own name, so slots can not point to wrong commands */
+        for (i = 0; i < self->commands_num; i++) {
+                cmd = get_command_by_index(self, i);
+
+                hash = CAT_HASH_INIT;
+                for (j = 0; cmd->name[j] != '\0'; j++)
+                        hash = cat_hash_update(hash, cmd->name[j]);
+
+                assert(get_cmd_hash_index(self, hash) == i);
+                assert(compare_cmd_names(cmd_hash->name[i], cmd->name) == 0);
+        }
+}
+
+static void init_commands(struct cat_object *self, const struct cat_descriptor *desc)
+{
+        size_t i, j;
+        struct cat_command_group const *cmd_group;
+
+        assert(desc->cmd_group != NULL);
+        assert(desc->cmd_group_num > 0);
 
         self->commands_num = 0;
         for (i = 0; i < desc->cmd_group_num; i++) {
@@ -470,6 +1226,7 @@ void cat_init(struct cat_object *self, const struct cat_descriptor *desc, const
                 assert(cmd_group->cmd != NULL);
                 assert(cmd_group->cmd_num > 0);
 
+                assert(cmd_group->cmd_num <= UINT32_MAX - self->commands_num);
                 self->commands_num += cmd_group->cmd_num;
 
                 for (j = 0; j < cmd_group->cmd_num; j++) {
@@ -482,19 +1239,205 @@ void cat_init(struct cat_object *self, const struct cat_descriptor *desc, const
                 }
         }
 
-        assert(desc->buf != NULL);
-        assert(desc->buf_size * 4U >= self->commands_num);
+        assert((desc->cmd_hash == NULL) || (desc->cmd_hash->num == self->commands_num));
+        assert((desc->cmd_hash == NULL) || (desc->cmd_index != NULL));
 
         self->desc = desc;
+
+        if (desc->cmd_table != NULL)
+                build_cmd_table(self);
+
+        if (desc->cmd_disable_buf != NULL)
+                update_cmd_disable_bitmap(self);
+
+        if (desc->cmd_meta != NULL)
+                build_cmd_meta(self);
+
+        if (desc->cmd_index != NULL)
+                build_cmd_index(self);
+
+        if (desc->cmd_addr_index != NULL)
+                build_cmd_addr_index(self);
+
+        if (desc->cmd_hash != NULL)
+                check_cmd_hash(self);
+}
+
+static void init_session(struct cat_object *self, const struct cat_session_config *config, const struct cat_io_interface *io, const struct cat_mutex_interface *mutex)
+{
+        size_t i;
+
+        assert(config->buf != NULL);
+        assert(config->buf_size <= UINT32_MAX);
+        assert(config->unsolicited_buf_size <= UINT32_MAX);
+
+        self->buf = config->buf;
+        if (config->unsolicited_buf != NULL) {
+                self->buf_size = config->buf_size;
+                self->unsolicited_buf = (char*)config->unsolicited_buf;
+                self->unsolicited_buf_size = config->unsolicited_buf_size;
+        } else {
+                /* working buffer is divided into atcmd and unsolicited parts */
+                self->buf_size = config->buf_size >> 1;
+                self->unsolicited_buf = (char*)&config->buf[config->buf_size >> 1];
+                self->unsolicited_buf_size = config->buf_size >> 1;
+        }
+
+        /* commands matching bitmap lives in atcmd part of working buffer */
+        assert((self->desc->cmd_index != NULL) || (get_atcmd_buf_size(self) * 4U >= self->commands_num));
+
+        assert((config->cmd_candidate == NULL) || (config->cmd_candidate_num >= self->commands_num));
+        self->cmd_candidate = config->cmd_candidate;
+
+        assert((has_io_read_block(io) == false) || ((config->input_buf != NULL) && (config->input_buf_size > 0)));
+        assert(config->input_buf_size <= UINT32_MAX);
+        self->input_buf = config->input_buf;
+        self->input_buf_size = config->input_buf_size;
+
+        assert((config->input_ring_buf == NULL) || ((config->input_ring_size > 0) && ((config->input_ring_size & (config->input_ring_size - 1)) == 0)));
+        assert(config->input_ring_size <= UINT32_MAX);
+        self->input_ring_buf = config->input_ring_buf;
+        self->input_ring_size = config->input_ring_size;
+
         self->io = io;
         self->mutex = mutex;
+        self->clock = NULL;
+        memset(&self->stats, 0, sizeof(self->stats));
+        self->input_pos = 0;
+        self->input_len = 0;
+        self->read_cntr = 0;
+        self->line = NULL;
+        atomic_init(&self->ring_head, 0);
+        atomic_init(&self->ring_tail, 0);
+        self->ring_head_cache = 0;
+        self->ring_tail_local = 0;
         self->hold_state_flag = false;
         self->hold_exit_status = 0;
         self->implicit_write_flag = false;
+        self->input_empty_flag = false;
+        self->output_blocked_flag = false;
+
+        self->async_tail = 0;
+        self->async_head = 0;
+        self->async_buf = config->async_buf;
+        self->async_buf_num = 0;
+        self->async_arena_buf = config->async_arena_buf;
+        self->async_arena_slot_size = 0;
+
+        if (config->async_buf != NULL) {
+                assert(config->async_buf_num > 0);
+                assert(config->async_buf_num <= UINT32_MAX);
+                self->async_buf_num = config->async_buf_num;
+                for (i = 0; i < config->async_buf_num; i++)
+                        atomic_init(&config->async_buf[i].sequence, CAT_ASYNC_SEQ_FREE(i));
+        }
+
+        if (config->async_arena_buf != NULL) {
+                assert(config->async_buf != NULL);
+                assert(config->async_arena_slot_size > 0);
+                assert(config->async_arena_slot_size <= get_atcmd_buf_size(self));
+                assert(config->async_arena_buf_size >= config->async_arena_slot_size * config->async_buf_num);
+                self->async_arena_slot_size = config->async_arena_slot_size;
+        }
+
+        self->unsolicited_pending_buf = config->unsolicited_pending_buf;
+        if (config->unsolicited_pending_buf != NULL) {
+                assert(self->desc->cmd_addr_index != NULL);
+                assert(config->unsolicited_pending_buf_size >= CAT_UNSOLICITED_PENDING_BUF_SIZE(self->commands_num));
+                for (i = 0; i < config->unsolicited_pending_buf_size; i++)
+                        atomic_init(&config->unsolicited_pending_buf[i], 0);
+        }
 
         reset_state(self);
 
-        unsolicited_init(self);
+        unsolicited_init(self, config);
+}
+
+void cat_init(struct cat_object *self, const struct cat_descriptor *desc, const struct cat_io_interface *io, const struct cat_mutex_interface *mutex)
+{
+        struct cat_session_config config;
+
+        assert(self != NULL);
+        assert(desc != NULL);
+        assert(io != NULL);
+
+        init_commands(self, desc);
+
+        /* per object storage configured in descriptor is used as storage of single session */
+        config.buf = desc->buf;
+        config.buf_size = desc->buf_size;
+        config.unsolicited_buf = desc->unsolicited_buf;
+        config.unsolicited_buf_size = desc->unsolicited_buf_size;
+        config.cmd_candidate = desc->cmd_candidate;
+        config.cmd_candidate_num = desc->cmd_candidate_num;
+        config.input_ring_buf = desc->input_ring_buf;
+        config.input_ring_size = desc->input_ring_size;
+        config.input_buf = desc->input_buf;
+        config.input_buf_size = desc->input_buf_size;
+        config.unsolicited_fsm = desc->unsolicited_fsm;
+        config.unsolicited_cmd_buf = desc->unsolicited_cmd_buf;
+        config.unsolicited_cmd_buf_num = desc->unsolicited_cmd_buf_num;
+        config.unsolicited_low_cmd_buf = desc->unsolicited_low_cmd_buf;
+        config.unsolicited_low_cmd_buf_num = desc->unsolicited_low_cmd_buf_num;
+        config.unsolicited_high_cmd_buf = desc->unsolicited_high_cmd_buf;
+        config.unsolicited_high_cmd_buf_num = desc->unsolicited_high_cmd_buf_num;
+        config.unsolicited_arena_buf = desc->unsolicited_arena_buf;
+        config.unsolicited_arena_buf_size = desc->unsolicited_arena_buf_size;
+        config.unsolicited_arena_slot_size = desc->unsolicited_arena_slot_size;
+        config.unsolicited_pending_buf = desc->unsolicited_pending_buf;
+        config.unsolicited_pending_buf_size = desc->unsolicited_pending_buf_size;
+        config.async_buf = desc->async_buf;
+        config.async_buf_num = desc->async_buf_num;
+        config.async_arena_buf = desc->async_arena_buf;
+        config.async_arena_buf_size = desc->async_arena_buf_size;
+        config.async_arena_slot_size = desc->async_arena_slot_size;
+
+        init_session(self, &config, io, mutex);
+}
+
+void cat_table_init(struct cat_table *table, const struct cat_descriptor *desc)
+{
+        struct cat_object obj;
+
+        assert(table != NULL);
+        assert(desc != NULL);
+
+        /* per object storage cannot be shared, sessions take it from session config */
+        assert(desc->buf == NULL);
+        assert(desc->unsolicited_buf == NULL);
+        assert(desc->cmd_candidate == NULL);
+        assert(desc->input_ring_buf == NULL);
+        assert(desc->input_buf == NULL);
+        assert(desc->unsolicited_cmd_buf == NULL);
+        assert(desc->unsolicited_low_cmd_buf == NULL);
+        assert(desc->unsolicited_high_cmd_buf == NULL);
+        assert(desc->unsolicited_arena_buf == NULL);
+        assert(desc->unsolicited_pending_buf == NULL);
+        assert(desc->async_buf == NULL);
+        assert(desc->async_arena_buf == NULL);
+
+        /* only commands part of temporary object is used by tables builders */
+        obj.cmd_index_last = 0;
+        init_commands(&obj, desc);
+
+        table->desc = desc;
+        table->commands_num = obj.commands_num;
+        table->cmd_index_last = obj.cmd_index_last;
+}
+
+void cat_init_session(struct cat_object *self, const struct cat_table *table, const struct cat_session_config *config, const struct cat_io_interface *io, const struct cat_mutex_interface *mutex)
+{
+        assert(self != NULL);
+        assert(table != NULL);
+        assert(table->desc != NULL);
+        assert(config != NULL);
+        assert(io != NULL);
+
+        self->desc = table->desc;
+        self->commands_num = table->commands_num;
+        self->cmd_index_last = table->cmd_index_last;
+
+        init_session(self, config, io, mutex);
 }
 
 static cat_status error_state(struct cat_object *self)
@@ -524,10 +1467,17 @@ static void prepare_parse_command(struct cat_object *self)
 
         assert(self != NULL);
 
-        memset(get_atcmd_buf(self), val, get_atcmd_buf_size(self));
+        if (self->desc->cmd_index != NULL) {
+                self->cmd_index_begin = 0;
+                self->cmd_index_end = self->commands_num;
+        } else {
+                memset(get_atcmd_buf(self), val, get_atcmd_buf_size(self));
+        }
 
         self->index = 0;
         self->length = 0;
+        self->name_hash = CAT_HASH_INIT;
+        self->candidate_num = 0;
         self->cmd_type = CAT_CMD_TYPE_RUN;
 }
 
@@ -597,6 +1547,13 @@ static void end_processing_with_error(struct cat_object *self, cat_fsm_type fsm)
                 ack_error(self);
                 break;
         case CAT_FSM_TYPE_UNSOLICITED:
+                if (self->unsolicited_fsm->batch_len > 0) {
+                        /* already batched responses are flushed, then failed event is processed again alone */
+                        get_unsolicited_base_buf(self)[self->unsolicited_fsm->batch_len] = 0;
+                        self->unsolicited_fsm->batch_offset = 0;
+                        unsolicited_start_flush_io_buffer(self, CAT_UNSOLICITED_STATE_AFTER_FLUSH_RETRY);
+                        break;
+                }
                 unsolicited_reset_state(self);
                 break;
         default:
@@ -614,6 +1571,13 @@ static void end_processing_with_ok(struct cat_object *self, cat_fsm_type fsm)
                 ack_ok(self);
                 break;
         case CAT_FSM_TYPE_UNSOLICITED:
+                if (self->unsolicited_fsm->batch_len > 0) {
+                        /* event without response is skipped, batching continues with already batched responses */
+                        get_unsolicited_base_buf(self)[self->unsolicited_fsm->batch_len] = 0;
+                        self->unsolicited_fsm->batch_offset = self->unsolicited_fsm->batch_len;
+                        unsolicited_start_flush_io_buffer(self, CAT_UNSOLICITED_STATE_AFTER_FLUSH_OK);
+                        break;
+                }
                 unsolicited_reset_state(self);
                 break;
         default:
@@ -631,7 +1595,7 @@ static void reset_position(struct cat_object *self, cat_fsm_type fsm)
                 self->position = 0;
                 break;
         case CAT_FSM_TYPE_UNSOLICITED:
-                self->unsolicited_fsm.position = 0;
+                self->unsolicited_fsm->position = 0;
                 break;
         default:
                 assert(false);
@@ -647,7 +1611,7 @@ static struct cat_variable* get_var_by_fsm(struct cat_object *self, cat_fsm_type
         case CAT_FSM_TYPE_ATCMD:
                 return (struct cat_variable*)self->var;
         case CAT_FSM_TYPE_UNSOLICITED:
-                return (struct cat_variable*)self->unsolicited_fsm.var;
+                return (struct cat_variable*)self->unsolicited_fsm->var;
         default:
                 assert(false);
         }
@@ -675,7 +1639,7 @@ static int print_response_test(struct cat_object *self, cat_fsm_type fsm)
                         self->state = CAT_STATE_TEST_LOOP;
                         break;
                 case CAT_FSM_TYPE_UNSOLICITED:
-                        self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_TEST_LOOP;
+                        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_TEST_LOOP;
                         break;
                 default:
                         assert(false);
@@ -735,6 +1699,8 @@ static cat_status parse_command(struct cat_object *self)
                 break;
         default:
                 if (is_valid_cmd_name_char(self->current_char) != 0) {
+                        if (self->desc->cmd_hash != NULL)
+                                self->name_hash = cat_hash_update(self->name_hash, self->current_char);
                         self->length++;
                         self->state = CAT_STATE_UPDATE_COMMAND_STATE;
                         break;
@@ -753,6 +1719,9 @@ static bool is_command_disable(struct cat_object *self, size_t index)
         assert(self != NULL);
         assert(index < self->commands_num);
 
+        if (self->desc->cmd_disable_buf != NULL)
+                return ((self->desc->cmd_disable_buf[index >> 3] >> (index & 0x07)) & 0x01) != 0;
+
         j = 0;
         for (i = 0; i < self->desc->cmd_group_num; i++) {
                 cmd_group = self->desc->cmd_group[i];
@@ -806,41 +1775,173 @@ static void set_cmd_state(struct cat_object *self, size_t i, uint8_t state)
         get_atcmd_buf(self)[n] = s;
 }
 
-static cat_status update_command(struct cat_object *self)
+static uint8_t update_command_state(struct cat_object *self, size_t index)
 {
+        struct cat_command const *cmd;
+        struct cat_command_meta const *meta;
+        size_t cmd_name_len;
+        char cmd_char;
+
         assert(self != NULL);
 
-        struct cat_command const *cmd = get_command_by_index(self, self->index);
-        size_t cmd_name_len;
+        if (get_cmd_state(self, index) == CAT_CMD_STATE_NOT_MATCH)
+                return CAT_CMD_STATE_NOT_MATCH;
 
-        if (get_cmd_state(self, self->index) != CAT_CMD_STATE_NOT_MATCH) {
+        cmd = NULL;
+        if (self->desc->cmd_meta != NULL) {
+                meta = &self->desc->cmd_meta[index];
+                cmd_name_len = meta->name_len;
+                cmd_char = (self->length <= cmd_name_len) ? meta->name[self->length - 1] : '\0';
+        } else {
+                cmd = get_command_by_index(self, index);
                 cmd_name_len = strlen(cmd->name);
+                cmd_char = (self->length <= cmd_name_len) ? to_upper(cmd->name[self->length - 1]) : '\0';
+        }
 
-                if (self->length > cmd_name_len) {
-                        set_cmd_state(self, self->index, CAT_CMD_STATE_NOT_MATCH);
-                } else if (to_upper(cmd->name[self->length - 1]) != self->current_char) {
-                        set_cmd_state(self, self->index, CAT_CMD_STATE_NOT_MATCH);
-                } else if (self->length == cmd_name_len) {
-                        set_cmd_state(self, self->index, CAT_CMD_STATE_FULL_MATCH);
+        if ((self->length > cmd_name_len) || (cmd_char != self->current_char)) {
+                set_cmd_state(self, index, CAT_CMD_STATE_NOT_MATCH);
+                return CAT_CMD_STATE_NOT_MATCH;
+        }
+
+        if (self->length == cmd_name_len) {
+                set_cmd_state(self, index, CAT_CMD_STATE_FULL_MATCH);
+
+                if (cmd == NULL)
+                        cmd = get_command_by_index(self, index);
+                if (cmd->implicit_write != false)
+                        self->implicit_write_flag = true;
+
+                return CAT_CMD_STATE_FULL_MATCH;
+        }
+
+        return CAT_CMD_STATE_PARTIAL_MATCH;
+}
 
-                        if (cmd->implicit_write != false)
-                                self->implicit_write_flag = true;
+static void update_command_first_char(struct cat_object *self)
+{
+        size_t i;
+        struct cat_command_meta const *meta;
+
+        assert(self != NULL);
+
+        /* first char step visits every command, so only inlined bucket char is compared */
+        for (i = 0; i < self->commands_num; i++) {
+                meta = &self->desc->cmd_meta[i];
+                if (meta->first_char != self->current_char) {
+                        set_cmd_state(self, i, CAT_CMD_STATE_NOT_MATCH);
+                } else if (meta->name_len == 1) {
+                        update_command_state(self, i);
                 }
         }
+}
 
-        if (++self->index >= self->commands_num) {
-                self->index = 0;
+static char get_cmd_index_char(struct cat_object *self, size_t pos, size_t n)
+{
+        struct cat_command_index const *item = &self->desc->cmd_index[pos];
+
+        if (self->desc->cmd_meta != NULL)
+                return self->desc->cmd_meta[item->index].name[n];
+
+        return to_upper(item->cmd->name[n]);
+}
 
-                if (self->implicit_write_flag == false) {
-                        self->state = CAT_STATE_PARSE_COMMAND_CHAR;
+static size_t search_cmd_index_char(struct cat_object *self, size_t begin, size_t end, size_t n, char ch, bool upper)
+{
+        size_t mid;
+        char cmd_ch;
+
+        while (begin < end) {
+                mid = begin + ((end - begin) >> 1);
+                cmd_ch = get_cmd_index_char(self, mid, n);
+                if ((cmd_ch < ch) || ((upper != false) && (cmd_ch == ch))) {
+                        begin = mid + 1;
                 } else {
-                        self->cmd_type = CAT_CMD_TYPE_WRITE;
-                        prepare_search_command(self);
-                        self->state = CAT_STATE_SEARCH_COMMAND;
-                        self->implicit_write_flag = false;
+                        end = mid;
+                }
+        }
+
+        return begin;
+}
+
+static void update_command_index(struct cat_object *self)
+{
+        size_t n = self->length - 1;
+        size_t i;
+        struct cat_command_index const *item;
+
+        assert(self != NULL);
+
+        /* all entries in range share already parsed prefix, so they are sorted by current char */
+        self->cmd_index_begin = search_cmd_index_char(self, self->cmd_index_begin, self->cmd_index_end, n, self->current_char, false);
+        self->cmd_index_end = search_cmd_index_char(self, self->cmd_index_begin, self->cmd_index_end, n, self->current_char, true);
+
+        /* full matched entries are sorted before partial matched */
+        for (i = self->cmd_index_begin; i < self->cmd_index_end; i++) {
+                item = &self->desc->cmd_index[i];
+                if (get_cmd_index_char(self, i, self->length) != '\0')
+                        break;
+                if ((item->cmd->implicit_write != false) && (is_command_disable(self, item->index) == false))
+                        self->implicit_write_flag = true;
+        }
+}
+
+static void update_command_candidates(struct cat_object *self)
+{
+        size_t *candidate = self->cmd_candidate;
+        struct cat_command_meta const *meta = self->desc->cmd_meta;
+        size_t i, n;
+
+        assert(self != NULL);
+
+        n = 0;
+        if (self->length == 1) {
+                /* first char is the only step which visits every registered command */
+                for (i = 0; i < self->commands_num; i++) {
+                        if ((meta != NULL) && (meta[i].first_char != self->current_char)) {
+                                set_cmd_state(self, i, CAT_CMD_STATE_NOT_MATCH);
+                                continue;
+                        }
+                        if (update_command_state(self, i) != CAT_CMD_STATE_NOT_MATCH)
+                                candidate[n++] = i;
+                }
+        } else {
+                /* list is compacted in place, so it stays sorted by global command index */
+                for (i = 0; i < self->candidate_num; i++) {
+                        if (update_command_state(self, candidate[i]) != CAT_CMD_STATE_NOT_MATCH)
+                                candidate[n++] = candidate[i];
                 }
         }
 
+        self->candidate_num = n;
+}
+
+static cat_status update_command(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        if (self->desc->cmd_index != NULL) {
+                update_command_index(self);
+        } else if (self->cmd_candidate != NULL) {
+                update_command_candidates(self);
+        } else if ((self->desc->cmd_meta != NULL) && (self->length == 1)) {
+                update_command_first_char(self);
+        } else {
+                /* whole candidates set is updated within single service step */
+                for (self->index = 0; self->index < self->commands_num; self->index++)
+                        update_command_state(self, self->index);
+        }
+
+        self->index = 0;
+
+        if (self->implicit_write_flag == false) {
+                self->state = CAT_STATE_PARSE_COMMAND_CHAR;
+        } else {
+                self->cmd_type = CAT_CMD_TYPE_WRITE;
+                prepare_search_command(self);
+                self->state = CAT_STATE_SEARCH_COMMAND;
+                self->implicit_write_flag = false;
+        }
+
         return CAT_STATUS_BUSY;
 }
 
@@ -893,9 +1994,9 @@ static void start_processing_format_test_args(struct cat_object *self, cat_fsm_t
                         self->var = cmd->var;
                         break;
                 case CAT_FSM_TYPE_UNSOLICITED:
-                        self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_FORMAT_TEST_ARGS;
-                        self->unsolicited_fsm.index = 0;
-                        self->unsolicited_fsm.var = cmd->var;
+                        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_FORMAT_TEST_ARGS;
+                        self->unsolicited_fsm->index = 0;
+                        self->unsolicited_fsm->var = cmd->var;
                         break;
                 default:
                         assert(false);
@@ -930,37 +2031,162 @@ static cat_status wait_test_acknowledge(struct cat_object *self)
         return CAT_STATUS_BUSY;
 }
 
-static cat_status search_command(struct cat_object *self)
+static void search_command_index(struct cat_object *self)
 {
+        size_t i;
+        struct cat_command_index const *item;
+        struct cat_command_index const *last;
+
         assert(self != NULL);
 
-        uint8_t cmd_state = get_cmd_state(self, self->index);
+        for (i = self->cmd_index_begin; i < self->cmd_index_end; i++) {
+                item = &self->desc->cmd_index[i];
+                if (is_command_disable(self, item->index) != false)
+                        continue;
 
-        if (cmd_state != CAT_CMD_STATE_NOT_MATCH) {
-                if (cmd_state == CAT_CMD_STATE_PARTIAL_MATCH) {
-                        if ((self->cmd != NULL) && ((self->index + 1) == self->commands_num)) {
-                                self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
-                                return CAT_STATUS_BUSY;
-                        }
-                        self->cmd = get_command_by_index(self, self->index);
-                        self->partial_cntr++;
-                } else if (cmd_state == CAT_CMD_STATE_FULL_MATCH) {
-                        self->cmd = get_command_by_index(self, self->index);
+                if (get_cmd_index_char(self, i, self->length) == '\0') {
+                        self->cmd = item->cmd;
                         self->state = CAT_STATE_COMMAND_FOUND;
-                        return CAT_STATUS_BUSY;
+                        return;
                 }
+
+                self->cmd = item->cmd;
+                if (++self->partial_cntr > 1)
+                        break;
         }
 
-        if (++self->index >= self->commands_num) {
-                if (self->cmd == NULL) {
-                        self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
-                } else {
-                        self->state = (self->partial_cntr == 1) ? CAT_STATE_COMMAND_FOUND : CAT_STATE_COMMAND_NOT_FOUND;
-                }
+        if (self->cmd == NULL) {
+                self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
+                return;
         }
 
-        return CAT_STATUS_BUSY;
-}
+        if (self->partial_cntr == 1) {
+                self->state = CAT_STATE_COMMAND_FOUND;
+                return;
+        }
+
+        /* keep the same ambiguous shortcut response as linear scan, which stops at last registered command */
+        last = &self->desc->cmd_index[self->cmd_index_last];
+        if ((self->cmd_index_last >= self->cmd_index_begin) && (self->cmd_index_last < self->cmd_index_end) &&
+            (get_cmd_index_char(self, self->cmd_index_last, self->length) != '\0') && (is_command_disable(self, last->index) == false)) {
+                self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
+                return;
+        }
+
+        self->state = CAT_STATE_COMMAND_NOT_FOUND;
+}
+
+static void search_command_candidates(struct cat_object *self)
+{
+        size_t i, index;
+        uint8_t cmd_state;
+
+        assert(self != NULL);
+
+        /* same resolution as linear scan, but commands outside of the list are known to not match */
+        for (i = 0; i < self->candidate_num; i++) {
+                index = self->cmd_candidate[i];
+                cmd_state = get_cmd_state(self, index);
+
+                if (cmd_state == CAT_CMD_STATE_FULL_MATCH) {
+                        self->cmd = get_command_by_index(self, index);
+                        self->state = CAT_STATE_COMMAND_FOUND;
+                        return;
+                }
+
+                if (cmd_state == CAT_CMD_STATE_PARTIAL_MATCH) {
+                        if ((self->cmd != NULL) && ((index + 1) == self->commands_num)) {
+                                self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
+                                return;
+                        }
+                        self->cmd = get_command_by_index(self, index);
+                        self->partial_cntr++;
+                }
+        }
+
+        if (self->cmd == NULL) {
+                self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
+        } else {
+                self->state = (self->partial_cntr == 1) ? CAT_STATE_COMMAND_FOUND : CAT_STATE_COMMAND_NOT_FOUND;
+        }
+}
+
+static bool search_command_hash(struct cat_object *self)
+{
+        size_t index;
+        size_t i;
+        struct cat_command_index const *item;
+
+        assert(self != NULL);
+
+        index = get_cmd_hash_index(self, self->name_hash);
+
+        /* hash slot is confirmed by full matched entries of commands index range */
+        for (i = self->cmd_index_begin; i < self->cmd_index_end; i++) {
+                item = &self->desc->cmd_index[i];
+                if (get_cmd_index_char(self, i, self->length) != '\0')
+                        return false;
+                if (item->index == index)
+                        break;
+        }
+        if ((i >= self->cmd_index_end) || (is_command_disable(self, index) != false))
+                return false;
+
+        self->cmd = get_command_by_index(self, index);
+        self->state = CAT_STATE_COMMAND_FOUND;
+        return true;
+}
+
+static cat_status search_command(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        uint8_t cmd_state;
+
+        /* full matched name is resolved directly, shortcuts still need candidates search */
+        if ((self->desc->cmd_hash != NULL) && (search_command_hash(self) != false))
+                return CAT_STATUS_BUSY;
+
+        if (self->desc->cmd_index != NULL) {
+                search_command_index(self);
+                return CAT_STATUS_BUSY;
+        }
+
+        if (self->cmd_candidate != NULL) {
+                search_command_candidates(self);
+                return CAT_STATUS_BUSY;
+        }
+
+        /* all candidates are resolved within single service step */
+        while (self->state == CAT_STATE_SEARCH_COMMAND) {
+                cmd_state = get_cmd_state(self, self->index);
+
+                if (cmd_state != CAT_CMD_STATE_NOT_MATCH) {
+                        if (cmd_state == CAT_CMD_STATE_PARTIAL_MATCH) {
+                                if ((self->cmd != NULL) && ((self->index + 1) == self->commands_num)) {
+                                        self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
+                                        break;
+                                }
+                                self->cmd = get_command_by_index(self, self->index);
+                                self->partial_cntr++;
+                        } else if (cmd_state == CAT_CMD_STATE_FULL_MATCH) {
+                                self->cmd = get_command_by_index(self, self->index);
+                                self->state = CAT_STATE_COMMAND_FOUND;
+                                break;
+                        }
+                }
+
+                if (++self->index >= self->commands_num) {
+                        if (self->cmd == NULL) {
+                                self->state = (self->current_char == '\n') ? CAT_STATE_COMMAND_NOT_FOUND : CAT_STATE_ERROR;
+                        } else {
+                                self->state = (self->partial_cntr == 1) ? CAT_STATE_COMMAND_FOUND : CAT_STATE_COMMAND_NOT_FOUND;
+                        }
+                }
+        }
+
+        return CAT_STATUS_BUSY;
+}
 
 static void start_processing_format_read_args(struct cat_object *self, cat_fsm_type fsm)
 {
@@ -989,9 +2215,9 @@ static void start_processing_format_read_args(struct cat_object *self, cat_fsm_t
                         self->var = cmd->var;
                         break;
                 case CAT_FSM_TYPE_UNSOLICITED:
-                        self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_FORMAT_READ_ARGS;
-                        self->unsolicited_fsm.index = 0;
-                        self->unsolicited_fsm.var = cmd->var;
+                        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_FORMAT_READ_ARGS;
+                        self->unsolicited_fsm->index = 0;
+                        self->unsolicited_fsm->var = cmd->var;
                         break;
                 default:
                         assert(false);
@@ -1009,13 +2235,66 @@ static void start_processing_format_read_args(struct cat_object *self, cat_fsm_t
                 self->state = CAT_STATE_READ_LOOP;
                 break;
         case CAT_FSM_TYPE_UNSOLICITED:
-                self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_READ_LOOP;
+                self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_READ_LOOP;
                 break;
         default:
                 assert(false);
         }
 }
 
+static void start_processing_write_args(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        if (self->cmd->only_test != false) {
+                ack_error(self);
+                return;
+        }
+        if (is_variables_access_possible(self, self->cmd, CAT_VAR_ACCESS_WRITE_ONLY) != false) {
+                self->state = CAT_STATE_PARSE_WRITE_ARGS;
+                self->position = 0;
+                self->index = 0;
+                self->var = &self->cmd->var[self->index];
+                return;
+        }
+        if (self->cmd->write == NULL) {
+                ack_error(self);
+                return;
+        }
+        self->index = 0;
+        self->state = CAT_STATE_WRITE_LOOP;
+}
+
+static bool parse_line_args(struct cat_object *self)
+{
+        char const *args = &self->line[self->line_pos];
+        size_t len = self->line_len - self->line_pos;
+        char const *end;
+
+        assert(self != NULL);
+
+        /* test request and empty arguments are left for regular chars parsing */
+        if ((len == 0) || (args[0] == '?') || (args[0] == '\n'))
+                return false;
+
+        /* arguments end at embedded new line char, next command is parsed after it */
+        end = memchr(args, '\n', len);
+        if (end != NULL)
+                len = end - args;
+        self->line_pos += len + 1;
+
+        if ((len > 0) && (args[len - 1] == '\r')) {
+                self->cr_flag = true;
+                len--;
+        }
+
+        self->args = args;
+        self->length = len;
+
+        start_processing_write_args(self);
+        return true;
+}
+
 static cat_status command_found(struct cat_object *self)
 {
         assert(self != NULL);
@@ -1043,6 +2322,8 @@ static cat_status command_found(struct cat_object *self)
         case CAT_CMD_TYPE_WRITE:
                 self->length = 0;
                 get_atcmd_buf(self)[0] = 0;
+                if ((self->line != NULL) && (parse_line_args(self) != false))
+                        break;
                 self->state = CAT_STATE_PARSE_COMMAND_ARGS;
                 break;
         default:
@@ -1061,6 +2342,24 @@ static cat_status command_not_found(struct cat_object *self)
         return CAT_STATUS_BUSY;
 }
 
+static char read_args_char(struct cat_object *self)
+{
+        char ch;
+
+        if (self->args == NULL)
+                return get_atcmd_buf(self)[self->position++];
+
+        /* arguments parsed in place are not null terminated */
+        ch = (self->position < self->length) ? self->args[self->position] : 0;
+        self->position++;
+        return ch;
+}
+
+static char const* get_args_buf(struct cat_object *self)
+{
+        return (self->args != NULL) ? self->args : get_atcmd_buf(self);
+}
+
 static int parse_int_decimal(struct cat_object *self, int64_t *ret)
 {
         assert(self != NULL);
@@ -1072,7 +2371,7 @@ static int parse_int_decimal(struct cat_object *self, int64_t *ret)
         int ok = 0;
 
         while (1) {
-                ch = get_atcmd_buf(self)[self->position++];
+                ch = read_args_char(self);
 
                 if ((ok != 0) && ((ch == 0) || (ch == ','))) {
                         val *= sign;
@@ -1116,7 +2415,7 @@ static int parse_uint_decimal(struct cat_object *self, uint64_t *ret)
         int ok = 0;
 
         while (1) {
-                ch = get_atcmd_buf(self)[self->position++];
+                ch = read_args_char(self);
 
                 if ((ok != 0) && ((ch == 0) || (ch == ','))) {
                         *ret = val;
@@ -1145,7 +2444,7 @@ static int parse_num_hexadecimal(struct cat_object *self, uint64_t *ret)
         int state = 0;
 
         while (1) {
-                ch = get_atcmd_buf(self)[self->position++];
+                ch = read_args_char(self);
                 ch = to_upper(ch);
 
                 if ((state >= 3) && ((ch == 0) || (ch == ','))) {
@@ -1185,7 +2484,7 @@ static int parse_buffer_hexadecimal(struct cat_object *self)
         size_t size = 0;
 
         while (1) {
-                ch = get_atcmd_buf(self)[self->position++];
+                ch = read_args_char(self);
                 ch = to_upper(ch);
 
                 if ((size > 0) && (state == 0) && ((ch == 0) || (ch == ','))) {
@@ -1229,7 +2528,7 @@ static int parse_buffer_string(struct cat_object *self)
         size_t size = 0;
 
         while (1) {
-                ch = get_atcmd_buf(self)[self->position++];
+                ch = read_args_char(self);
 
                 switch (state) {
                 case 0:
@@ -1450,32 +2749,37 @@ static cat_status parse_write_args(struct cat_object *self)
         return CAT_STATUS_BUSY;
 }
 
-static int print_format_num(struct cat_object *self, char *fmt, uint32_t val, cat_fsm_type fsm)
+static int print_format_num(char *buf, size_t size, char *fmt, uint32_t val)
 {
         int written;
-        size_t len;
 
-        assert(self != NULL);
-        assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
+        assert(buf != NULL);
 
-        len = get_left_buffer_space_by_fsm(self, fsm);
-        written = snprintf(get_current_buffer_by_fsm(self, fsm), len, fmt, val);
+        written = snprintf(buf, size, fmt, val);
 
-        if ((written < 0) || ((size_t)written >= len))
+        if ((written < 0) || ((size_t)written >= size))
                 return -1;
 
-        move_position_by_fsm(self, written, fsm);
-        return 0;
+        return written;
 }
 
-static int format_int_decimal(struct cat_object *self, cat_fsm_type fsm)
+static int print_nstring(char *buf, size_t size, size_t pos, const char *str, size_t len)
 {
-        int32_t val;
+        assert(buf != NULL);
 
-        assert(self != NULL);
-        assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
+        if (pos + len >= size)
+                return -1;
 
-        struct cat_variable *var = get_var_by_fsm(self, fsm);
+        memcpy(&buf[pos], str, len);
+        buf[pos + len] = '\0';
+        return pos + len;
+}
+
+static int format_int_decimal(struct cat_variable const *var, char *buf, size_t size)
+{
+        int32_t val;
+
+        assert(var != NULL);
 
         switch (var->data_size) {
         case 1:
@@ -1494,20 +2798,14 @@ static int format_int_decimal(struct cat_object *self, cat_fsm_type fsm)
         if (var->access == CAT_VAR_ACCESS_WRITE_ONLY)
                 val = 0;
 
-        if (print_format_num(self, "%d", val, fsm) != 0)
-                return -1;
-
-        return 0;
+        return print_format_num(buf, size, "%d", val);
 }
 
-static int format_uint_decimal(struct cat_object *self, cat_fsm_type fsm)
+static int format_uint_decimal(struct cat_variable const *var, char *buf, size_t size)
 {
         uint32_t val;
 
-        assert(self != NULL);
-        assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
-
-        struct cat_variable *var = get_var_by_fsm(self, fsm);
+        assert(var != NULL);
 
         switch (var->data_size) {
         case 1:
@@ -1526,21 +2824,15 @@ static int format_uint_decimal(struct cat_object *self, cat_fsm_type fsm)
         if (var->access == CAT_VAR_ACCESS_WRITE_ONLY)
                 val = 0;
 
-        if (print_format_num(self, "%u", val, fsm) != 0)
-                return -1;
-
-        return 0;
+        return print_format_num(buf, size, "%u", val);
 }
 
-static int format_num_hexadecimal(struct cat_object *self, cat_fsm_type fsm)
+static int format_num_hexadecimal(struct cat_variable const *var, char *buf, size_t size)
 {
         uint32_t val;
         char fstr[8];
 
-        assert(self != NULL);
-        assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
-
-        struct cat_variable *var = get_var_by_fsm(self, fsm);
+        assert(var != NULL);
 
         switch (var->data_size) {
         case 1:
@@ -1562,82 +2854,124 @@ static int format_num_hexadecimal(struct cat_object *self, cat_fsm_type fsm)
         if (var->access == CAT_VAR_ACCESS_WRITE_ONLY)
                 val = 0;
 
-        if (print_format_num(self, fstr, val, fsm) != 0)
-                return -1;
-
-        return 0;
+        return print_format_num(buf, size, fstr, val);
 }
 
-static int format_buffer_hexadecimal(struct cat_object *self, cat_fsm_type fsm)
+static int format_buffer_hexadecimal(struct cat_variable const *var, char *buf, size_t size)
 {
         size_t i;
-        uint8_t *buf;
+        uint8_t *data;
         uint8_t val;
+        int written;
+        size_t pos = 0;
 
-        assert(self != NULL);
-        assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
-
-        struct cat_variable *var = get_var_by_fsm(self, fsm);
+        assert(var != NULL);
 
-        buf = var->data;
+        data = var->data;
         for (i = 0; i < var->data_size; i++) {
                 if (var->access == CAT_VAR_ACCESS_WRITE_ONLY) {
                         val = 0;
                 } else {
-                        val = buf[i];
+                        val = data[i];
                 }
 
-                if (print_format_num(self, "%02X", val, fsm) != 0)
+                written = print_format_num(&buf[pos], size - pos, "%02X", val);
+                if (written < 0)
                         return -1;
+                pos += written;
         }
-        return 0;
+        return pos;
 }
 
-static int format_buffer_string(struct cat_object *self, cat_fsm_type fsm)
+static int format_buffer_string(struct cat_variable const *var, char *buf, size_t size)
 {
         size_t i = 0;
-        char *buf;
-        size_t buf_size;
+        char *data;
+        size_t data_size;
         char ch;
+        int pos;
 
-        assert(self != NULL);
-        assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
-
-        struct cat_variable *var = get_var_by_fsm(self, fsm);
+        assert(var != NULL);
 
         if (var->access == CAT_VAR_ACCESS_WRITE_ONLY) {
-                buf_size = 0;
+                data_size = 0;
         } else {
-                buf_size = var->data_size;
+                data_size = var->data_size;
         }
 
-        if (print_string_to_buf(self, "\"", fsm) != 0)
+        pos = print_nstring(buf, size, 0, "\"", 1);
+        if (pos < 0)
                 return -1;
 
-        buf = var->data;
-        for (i = 0; i < buf_size; i++) {
-                ch = buf[i];
+        data = var->data;
+        for (i = 0; i < data_size; i++) {
+                ch = data[i];
                 if (ch == 0)
                         break;
                 if (ch == '\\') {
-                        if (print_string_to_buf(self, "\\\\", fsm) != 0)
-                                return -1;
+                        pos = print_nstring(buf, size, pos, "\\\\", 2);
                 } else if (ch == '"') {
-                        if (print_string_to_buf(self, "\\\"", fsm) != 0)
-                                return -1;
+                        pos = print_nstring(buf, size, pos, "\\\"", 2);
                 } else if (ch == '\n') {
-                        if (print_string_to_buf(self, "\\n", fsm) != 0)
-                                return -1;
+                        pos = print_nstring(buf, size, pos, "\\n", 2);
                 } else {
-                        if (print_nstring_to_buf(self, &ch, 1, fsm) != 0)
-                                return -1;
+                        pos = print_nstring(buf, size, pos, &ch, 1);
                 }
+                if (pos < 0)
+                        return -1;
         }
 
-        if (print_string_to_buf(self, "\"", fsm) != 0)
-                return -1;
+        return print_nstring(buf, size, pos, "\"", 1);
+}
 
-        return 0;
+static bool format_snapshot_vars(struct cat_command const *cmd, char *buf, size_t size)
+{
+        struct cat_variable const *var;
+        size_t i;
+        int pos;
+        int len;
+
+        assert(cmd != NULL);
+
+        pos = print_nstring(buf, size, 0, cmd->name, strlen(cmd->name));
+        if (pos >= 0)
+                pos = print_nstring(buf, size, pos, "=", 1);
+
+        for (i = 0; (i < cmd->var_num) && (pos >= 0); i++) {
+                var = &cmd->var[i];
+
+                if ((i > 0) && ((pos = print_nstring(buf, size, pos, ",", 1)) < 0))
+                        break;
+
+                if ((var->read != NULL) && (var->read(var) != 0))
+                        return false;
+
+                switch (var->type) {
+                case CAT_VAR_INT_DEC:
+                        len = format_int_decimal(var, &buf[pos], size - pos);
+                        break;
+                case CAT_VAR_UINT_DEC:
+                        len = format_uint_decimal(var, &buf[pos], size - pos);
+                        break;
+                case CAT_VAR_NUM_HEX:
+                        len = format_num_hexadecimal(var, &buf[pos], size - pos);
+                        break;
+                case CAT_VAR_BUF_HEX:
+                        len = format_buffer_hexadecimal(var, &buf[pos], size - pos);
+                        break;
+                case CAT_VAR_BUF_STRING:
+                        len = format_buffer_string(var, &buf[pos], size - pos);
+                        break;
+                default:
+                        return false;
+                }
+
+                if (len < 0)
+                        return false;
+                pos += len;
+        }
+
+        return pos >= 0;
 }
 
 static int format_info_type(struct cat_object *self, cat_fsm_type fsm)
@@ -1763,13 +3097,13 @@ static cat_status next_format_var_by_fsm(struct cat_object *self, cat_fsm_type f
                 }
                 break;
         case CAT_FSM_TYPE_UNSOLICITED:
-                if (++self->unsolicited_fsm.index < cmd->var_num) {
-                        if (self->unsolicited_fsm.position >= get_unsolicited_buf_size(self)) {
+                if (++self->unsolicited_fsm->index < cmd->var_num) {
+                        if (self->unsolicited_fsm->position >= get_unsolicited_buf_size(self)) {
                                 end_processing_with_error(self, fsm);
                                 return CAT_STATUS_BUSY;
                         }
-                        get_unsolicited_buf(self)[self->unsolicited_fsm.position++] = ',';
-                        self->unsolicited_fsm.var = &cmd->var[self->unsolicited_fsm.index];
+                        get_unsolicited_buf(self)[self->unsolicited_fsm->position++] = ',';
+                        self->unsolicited_fsm->var = &cmd->var[self->unsolicited_fsm->index];
                         return CAT_STATUS_BUSY;
                 }
                 break;
@@ -1783,11 +3117,14 @@ static cat_status next_format_var_by_fsm(struct cat_object *self, cat_fsm_type f
 static cat_status format_read_args(struct cat_object *self, cat_fsm_type fsm)
 {
         cat_status stat;
+        int len;
 
         assert(self != NULL);
         assert(fsm < CAT_FSM_TYPE__TOTAL_NUM);
 
         struct cat_variable *var = get_var_by_fsm(self, fsm);
+        char *buf = get_current_buffer_by_fsm(self, fsm);
+        size_t size = get_left_buffer_space_by_fsm(self, fsm);
 
         if ((var->read != NULL) && (var->read(var) != 0)) {
                 end_processing_with_error(self, fsm);
@@ -1796,28 +3133,29 @@ static cat_status format_read_args(struct cat_object *self, cat_fsm_type fsm)
 
         switch (var->type) {
         case CAT_VAR_INT_DEC:
-                stat = format_int_decimal(self, fsm);
+                len = format_int_decimal(var, buf, size);
                 break;
         case CAT_VAR_UINT_DEC:
-                stat = format_uint_decimal(self, fsm);
+                len = format_uint_decimal(var, buf, size);
                 break;
         case CAT_VAR_NUM_HEX:
-                stat = format_num_hexadecimal(self, fsm);
+                len = format_num_hexadecimal(var, buf, size);
                 break;
         case CAT_VAR_BUF_HEX:
-                stat = format_buffer_hexadecimal(self, fsm);
+                len = format_buffer_hexadecimal(var, buf, size);
                 break;
         case CAT_VAR_BUF_STRING:
-                stat = format_buffer_string(self, fsm);
+                len = format_buffer_string(var, buf, size);
                 break;
         default:
                 return CAT_STATUS_ERROR;
         }
 
-        if (stat < 0) {
+        if (len < 0) {
                 end_processing_with_error(self, fsm);
                 return CAT_STATUS_BUSY;
         }
+        move_position_by_fsm(self, len, fsm);
 
         stat = next_format_var_by_fsm(self, fsm);
         if (stat != CAT_STATUS_OK)
@@ -1831,7 +3169,7 @@ static cat_status format_read_args(struct cat_object *self, cat_fsm_type fsm)
                         self->state = CAT_STATE_READ_LOOP;
                         break;
                 case CAT_FSM_TYPE_UNSOLICITED:
-                        self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_READ_LOOP;
+                        self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_READ_LOOP;
                         break;
                 default:
                         assert(false);
@@ -1884,23 +3222,7 @@ static cat_status parse_command_args(struct cat_object *self)
 
         switch (self->current_char) {
         case '\n':
-                if (self->cmd->only_test != false) {
-                        ack_error(self);
-                        break;
-                }
-                if (is_variables_access_possible(self, self->cmd, CAT_VAR_ACCESS_WRITE_ONLY) != false) {
-                        self->state = CAT_STATE_PARSE_WRITE_ARGS;
-                        self->position = 0;
-                        self->index = 0;
-                        self->var = &self->cmd->var[self->index];
-                        break;
-                }
-                if (self->cmd->write == NULL) {
-                        ack_error(self);
-                        break;
-                }
-                self->index = 0;
-                self->state = CAT_STATE_WRITE_LOOP;
+                start_processing_write_args(self);
                 break;
         case '\r':
                 self->cr_flag = true;
@@ -1929,85 +3251,421 @@ static cat_status parse_command_args(struct cat_object *self)
         return CAT_STATUS_BUSY;
 }
 
-cat_status cat_trigger_unsolicited_event(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type)
+cat_status cat_trigger_unsolicited_event_priority(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type, cat_unsolicited_priority priority)
 {
-        cat_status s;
+        size_t bit;
 
         assert(self != NULL);
         assert(cmd != NULL);
         assert(((type == CAT_CMD_TYPE_READ) || (type == CAT_CMD_TYPE_TEST)));
+        assert(priority < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM);
 
-        if ((self->mutex != NULL) && (self->mutex->lock() != 0))
-                return CAT_STATUS_ERROR_MUTEX_LOCK;
-
-        s = push_unsolicited_cmd(self, cmd, type);
+        if (get_unsolicited_pending_bit(self, cmd, type, priority, &bit) == false)
+                return push_unsolicited_cmd(self, cmd, type, priority, NULL, 0);
 
-        if ((self->mutex != NULL) && (self->mutex->unlock() != 0))
-                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+        /* identical event is already pending, so this one is merged into it */
+        if (is_unsolicited_pending(self, bit) != false)
+                return CAT_STATUS_OK;
 
-        return s;
+        return push_unsolicited_cmd(self, cmd, type, priority, NULL, bit + 1);
 }
 
-cat_status cat_trigger_unsolicited_read(struct cat_object *self, struct cat_command const *cmd)
+cat_status cat_trigger_unsolicited_snapshot(struct cat_object *self, struct cat_command const *cmd, const char *args, cat_unsolicited_priority priority)
 {
-        return cat_trigger_unsolicited_event(self, cmd, CAT_CMD_TYPE_READ);
-}
+        assert(self != NULL);
+        assert(cmd != NULL);
+        assert(args != NULL);
+        assert(priority < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM);
 
-cat_status cat_trigger_unsolicited_test(struct cat_object *self, struct cat_command const *cmd)
-{
-        return cat_trigger_unsolicited_event(self, cmd, CAT_CMD_TYPE_TEST);
+        return push_unsolicited_cmd(self, cmd, CAT_CMD_TYPE_READ, priority, args, 0);
 }
 
-static void check_unsolicited_buffers(struct cat_object *self)
+cat_status cat_trigger_unsolicited_var_snapshot(struct cat_object *self, struct cat_command const *cmd, cat_unsolicited_priority priority)
 {
-        cat_cmd_type type;
+        struct cat_unsolicited_queue *queue;
+        struct cat_unsolicited_cmd *item;
+        size_t tail;
+        bool formatted;
 
         assert(self != NULL);
+        assert(cmd != NULL);
+        assert(priority < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM);
 
-        if (pop_unsolicited_cmd(self, &self->unsolicited_fsm.cmd, &type) != CAT_STATUS_OK)
-                return;
+        if (self->unsolicited_fsm == NULL)
+                return CAT_STATUS_ERROR_BUFFER_FULL;
 
-        self->unsolicited_fsm.cmd_type = type;
+        queue = get_unsolicited_queue(self, priority);
+        assert(self->unsolicited_fsm->arena != NULL);
 
-        switch (type) {
-        case CAT_CMD_TYPE_READ:
-                start_processing_format_read_args(self, CAT_FSM_TYPE_UNSOLICITED);
-                break;
-        case CAT_CMD_TYPE_TEST:
-                start_processing_format_test_args(self, CAT_FSM_TYPE_UNSOLICITED);
-                break;
-        default:
-                break;
+        /* variables are shared with cat_service (write commands), so they are read only under mutex */
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        if (is_variables_access_possible(self, cmd, CAT_VAR_ACCESS_READ_ONLY) == false) {
+                if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                        return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+                return CAT_STATUS_ERROR;
         }
-}
 
-static cat_status process_idle_state(struct cat_object *self)
-{
-        assert(self != NULL);
+        item = reserve_unsolicited_cell(self, queue, &tail);
+        if (item == NULL) {
+                if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                        return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+                return CAT_STATUS_ERROR_BUFFER_FULL;
+        }
 
-        if (read_cmd_char(self) == 0)
-                return CAT_STATUS_OK;
+        /* slot is owned by producer until cell is published, so variables are formatted straight into it */
+        formatted = format_snapshot_vars(cmd, get_unsolicited_queue_slot(self, queue, tail), self->unsolicited_fsm->arena_slot_size);
 
-        switch (self->current_char) {
-        case 'A':
-                self->state = CAT_STATE_PARSE_PREFIX;
-                break;
-        case '\n':
-        case '\r':
-                break;
-        default:
-                self->state = CAT_STATE_ERROR;
-                break;
+        item->cmd = cmd;
+        item->type = CAT_CMD_TYPE_READ;
+        item->snapshot = true;
+        item->pending_bit = 0;
+        /* response length is known only after formatting, so cell of too long response is published as empty one */
+        item->skip = (formatted == false);
+
+        /* only formatting needs mutex, enqueue stays lock-free */
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0)) {
+                item->skip = true;
+                publish_unsolicited_cell(queue, item, tail);
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
         }
 
-        return CAT_STATUS_BUSY;
+        publish_unsolicited_cell(queue, item, tail);
+
+        return (formatted != false) ? CAT_STATUS_OK : CAT_STATUS_ERROR;
 }
 
-static void enable_hold_state(struct cat_object *self)
+cat_status cat_trigger_unsolicited_event(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type)
+{
+        return cat_trigger_unsolicited_event_priority(self, cmd, type, CAT_UNSOLICITED_PRIORITY_NORMAL);
+}
+
+cat_status cat_get_unsolicited_rate_stats(struct cat_object *self, struct cat_unsolicited_rate_stats *stats, bool clear)
 {
         assert(self != NULL);
+        assert(stats != NULL);
 
-        self->state = CAT_STATE_HOLD;
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        if (self->unsolicited_fsm == NULL) {
+                stats->deferred_cntr = 0;
+                stats->dropped_cntr = 0;
+        } else if (clear != false) {
+                stats->deferred_cntr = self->unsolicited_fsm->deferred_cntr;
+                self->unsolicited_fsm->deferred_cntr = 0;
+                stats->dropped_cntr = atomic_exchange_explicit(&self->unsolicited_fsm->dropped_cntr, 0, memory_order_relaxed);
+        } else {
+                stats->deferred_cntr = self->unsolicited_fsm->deferred_cntr;
+                stats->dropped_cntr = atomic_load_explicit(&self->unsolicited_fsm->dropped_cntr, memory_order_relaxed);
+        }
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return CAT_STATUS_OK;
+}
+
+cat_status cat_get_unsolicited_queue_stats(struct cat_object *self, cat_unsolicited_priority priority, struct cat_unsolicited_queue_stats *stats, bool clear)
+{
+        struct cat_unsolicited_queue *queue;
+
+        assert(self != NULL);
+        assert(priority < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM);
+        assert(stats != NULL);
+
+        if (self->unsolicited_fsm == NULL) {
+                memset(stats, 0, sizeof(*stats));
+                return CAT_STATUS_OK;
+        }
+
+        queue = get_unsolicited_queue(self, priority);
+
+        stats->depth = get_unsolicited_queue_depth(queue);
+        stats->high_water_mark = atomic_load_explicit(&queue->high_water_mark, memory_order_relaxed);
+        stats->capacity = queue->buf_num;
+
+        if (clear != false)
+                atomic_store_explicit(&queue->high_water_mark, stats->depth, memory_order_relaxed);
+
+        return CAT_STATUS_OK;
+}
+
+cat_status cat_trigger_unsolicited_read(struct cat_object *self, struct cat_command const *cmd)
+{
+        return cat_trigger_unsolicited_event(self, cmd, CAT_CMD_TYPE_READ);
+}
+
+cat_status cat_trigger_unsolicited_test(struct cat_object *self, struct cat_command const *cmd)
+{
+        return cat_trigger_unsolicited_event(self, cmd, CAT_CMD_TYPE_TEST);
+}
+
+static bool pop_unsolicited_event(struct cat_object *self)
+{
+        cat_cmd_type type;
+
+        assert(self != NULL);
+
+        if (pop_unsolicited_cmd(self, &self->unsolicited_fsm->cmd, &type, &self->unsolicited_fsm->snapshot) != CAT_STATUS_OK)
+                return false;
+
+        self->unsolicited_fsm->cmd_type = type;
+        return true;
+}
+
+static void start_unsolicited_event(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        /* snapshot response was already copied into unsolicited buffer */
+        if (self->unsolicited_fsm->snapshot != false) {
+                unsolicited_start_flush_io_buffer(self, CAT_UNSOLICITED_STATE_AFTER_FLUSH_OK);
+                return;
+        }
+
+        switch (self->unsolicited_fsm->cmd_type) {
+        case CAT_CMD_TYPE_READ:
+                start_processing_format_read_args(self, CAT_FSM_TYPE_UNSOLICITED);
+                break;
+        case CAT_CMD_TYPE_TEST:
+                start_processing_format_test_args(self, CAT_FSM_TYPE_UNSOLICITED);
+                break;
+        default:
+                break;
+        }
+}
+
+static void check_unsolicited_buffers(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        if (pop_unsolicited_event(self) != false)
+                start_unsolicited_event(self);
+}
+
+static void batch_next_unsolicited_event(struct cat_object *self)
+{
+        char *buf;
+
+        assert(self != NULL);
+
+        /* responses are separated in the same way as if they were flushed one by one */
+        buf = &get_unsolicited_base_buf(self)[self->unsolicited_fsm->batch_len];
+        strcpy(buf, get_new_line_chars(self));
+        strcat(buf, get_new_line_chars(self));
+        self->unsolicited_fsm->batch_offset = self->unsolicited_fsm->batch_len + strlen(buf);
+
+        if (pop_unsolicited_event(self) == false) {
+                /* reserved event is not published yet or snapshot does not fit, so batch is flushed without it */
+                buf[0] = 0;
+                unsolicited_start_flush_batch(self, CAT_UNSOLICITED_STATE_AFTER_FLUSH_OK);
+                return;
+        }
+
+        start_unsolicited_event(self);
+}
+
+static inline char* get_async_slot(struct cat_object *self, size_t token)
+{
+        return &self->async_arena_buf[(token % self->async_buf_num) * self->async_arena_slot_size];
+}
+
+static inline struct cat_async_completion* get_async_cell(struct cat_object *self, size_t token)
+{
+        return &self->async_buf[token % self->async_buf_num];
+}
+
+static bool is_async_completion_ready(struct cat_object *self)
+{
+        if (self->async_head == self->async_tail)
+                return false;
+
+        return atomic_load_explicit(&get_async_cell(self, self->async_head)->sequence, memory_order_acquire) == CAT_ASYNC_SEQ_COMPLETED(self->async_head);
+}
+
+static bool is_async_stalled(struct cat_object *self)
+{
+        /* every completions buffer cell is reserved for command already in flight */
+        return (self->async_buf != NULL) && (self->async_tail - self->async_head >= self->async_buf_num);
+}
+
+static void prepare_async(struct cat_object *self)
+{
+        struct cat_async_completion *cell;
+
+        if (self->async_buf == NULL)
+                return;
+
+        /* free cell is guaranteed, because commands are not parsed when parser is stalled */
+        assert(is_async_stalled(self) == false);
+
+        /* cell is reserved before handler call, so worker can complete token even before handler returns */
+        /* cell of token is released by drain before token is handed out again (stale completions are rejected) */
+        cell = get_async_cell(self, self->async_tail);
+        assert(atomic_load_explicit(&cell->sequence, memory_order_relaxed) == CAT_ASYNC_SEQ_FREE(self->async_tail));
+
+        cell->cmd = self->cmd;
+        cell->cr_flag = self->cr_flag;
+        cell->discard = false;
+        atomic_store_explicit(&cell->sequence, CAT_ASYNC_SEQ_PENDING(self->async_tail), memory_order_release);
+}
+
+static void cancel_async(struct cat_object *self)
+{
+        struct cat_async_completion *cell;
+        size_t seq;
+
+        if (self->async_buf == NULL)
+                return;
+
+        cell = get_async_cell(self, self->async_tail);
+        seq = CAT_ASYNC_SEQ_PENDING(self->async_tail);
+        if (atomic_compare_exchange_strong_explicit(&cell->sequence, &seq, CAT_ASYNC_SEQ_FREE(self->async_tail), memory_order_relaxed, memory_order_relaxed) != false)
+                return;
+
+        /* token was already claimed by worker, handler response is written now and completion is dropped, */
+        /* cell stays in flight until worker finishes it, so its slot is not reused while worker writes to it */
+        cell->discard = true;
+        self->async_tail++;
+}
+
+static void start_async(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        if (self->async_buf == NULL) {
+                ack_error(self);
+                return;
+        }
+
+        self->async_tail++;
+        reset_state(self);
+}
+
+static bool drain_async_completion(struct cat_object *self)
+{
+        struct cat_async_completion *cell;
+
+        assert(self != NULL);
+
+        if (is_async_completion_ready(self) == false)
+                return false;
+
+        cell = get_async_cell(self, self->async_head);
+
+        /* dropped completion is only released, its command was already answered by handler */
+        if (cell->discard == false) {
+                self->cmd = cell->cmd;
+                self->cr_flag = cell->cr_flag;
+
+                if (cell->error != false) {
+                        ack_error(self);
+                } else if (cell->data != false) {
+                        strcpy(get_atcmd_buf(self), get_async_slot(self, self->async_head));
+                        start_flush_io_buffer(self, CAT_STATE_AFTER_FLUSH_OK);
+                } else {
+                        ack_ok(self);
+                }
+        }
+
+        /* release cell for next lap */
+        atomic_store_explicit(&cell->sequence, CAT_ASYNC_SEQ_FREE(self->async_head + self->async_buf_num), memory_order_relaxed);
+        self->async_head++;
+
+        return true;
+}
+
+size_t cat_async_get_token(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        return self->async_tail;
+}
+
+cat_status cat_async_complete(struct cat_object *self, size_t token, cat_status status, const char *data)
+{
+        struct cat_async_completion *cell;
+        size_t seq;
+        bool with_data;
+
+        assert(self != NULL);
+        assert(self->async_buf != NULL);
+
+        cell = get_async_cell(self, token);
+
+        /* error acknowledge is never preceded by response data */
+        with_data = (data != NULL) && (status == CAT_STATUS_OK);
+
+        if (with_data != false) {
+                if (self->async_arena_buf == NULL)
+                        return CAT_STATUS_ERROR;
+
+                /* command of pending token cannot change until token is completed */
+                if (atomic_load_explicit(&cell->sequence, memory_order_acquire) != CAT_ASYNC_SEQ_PENDING(token))
+                        return CAT_STATUS_ERROR_NOT_PENDING;
+
+                /* name, equal sign, data and terminator */
+                if (strlen(cell->cmd->name) + strlen(data) + 2 > self->async_arena_slot_size)
+                        return CAT_STATUS_ERROR;
+        }
+
+        /* only one completion of pending token is accepted (duplicated and stale tokens are rejected) */
+        seq = CAT_ASYNC_SEQ_PENDING(token);
+        if (atomic_compare_exchange_strong_explicit(&cell->sequence, &seq, CAT_ASYNC_SEQ_CLAIMED(token), memory_order_acquire, memory_order_relaxed) == false)
+                return CAT_STATUS_ERROR_NOT_PENDING;
+
+        cell->error = (status != CAT_STATUS_OK);
+        cell->data = with_data;
+
+        if (with_data != false) {
+                /* slot is owned by worker until cell is completed */
+                strcpy(get_async_slot(self, token), cell->cmd->name);
+                strcat(get_async_slot(self, token), "=");
+                strcat(get_async_slot(self, token), data);
+        }
+
+        atomic_store_explicit(&cell->sequence, CAT_ASYNC_SEQ_COMPLETED(token), memory_order_release);
+
+        return CAT_STATUS_OK;
+}
+
+static cat_status process_idle_state(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        /* completions are written between commands, so they never interleave with other responses */
+        if (drain_async_completion(self) != false)
+                return CAT_STATUS_BUSY;
+
+        /* next command is not parsed until its handler could go asynchronous */
+        if (is_async_stalled(self) != false)
+                return CAT_STATUS_OK;
+
+        if (read_cmd_char(self) == 0)
+                return CAT_STATUS_OK;
+
+        switch (self->current_char) {
+        case 'A':
+                self->state = CAT_STATE_PARSE_PREFIX;
+                break;
+        case '\n':
+        case '\r':
+                break;
+        default:
+                self->state = CAT_STATE_ERROR;
+                break;
+        }
+
+        return CAT_STATUS_BUSY;
+}
+
+static void enable_hold_state(struct cat_object *self)
+{
+        assert(self != NULL);
+
+        self->state = CAT_STATE_HOLD;
         self->hold_state_flag = true;
         self->hold_exit_status = 0;
 }
@@ -2065,8 +3723,13 @@ static int print_current_cmd_full_name(struct cat_object *self, const char *suff
 
         if (print_string_to_buf(self, "AT", CAT_FSM_TYPE_ATCMD) != 0)
                 return -1;
-        if (print_string_to_buf(self, self->cmd->name, CAT_FSM_TYPE_ATCMD) != 0)
-                return -1;
+        if (self->desc->cmd_meta != NULL) {
+                if (print_nstring_to_buf(self, self->cmd->name, self->desc->cmd_meta[self->index].name_len, CAT_FSM_TYPE_ATCMD) != 0)
+                        return -1;
+        } else {
+                if (print_string_to_buf(self, self->cmd->name, CAT_FSM_TYPE_ATCMD) != 0)
+                        return -1;
+        }
         if (print_string_to_buf(self, suffix, CAT_FSM_TYPE_ATCMD) != 0)
                 return -1;
         if (print_string_to_buf(self, get_new_line_chars(self), CAT_FSM_TYPE_ATCMD) != 0)
@@ -2145,9 +3808,16 @@ static void print_cmd_list(struct cat_object *self)
 
 static cat_status process_write_loop(struct cat_object *self)
 {
+        cat_return_state ret;
+
         assert(self != NULL);
 
-        switch (self->cmd->write(self->cmd, (uint8_t*)get_atcmd_buf(self), self->length, self->index)) {
+        prepare_async(self);
+        ret = self->cmd->write(self->cmd, (const uint8_t*)get_args_buf(self), self->length, self->index);
+        if (ret != CAT_RETURN_STATE_ASYNC)
+                cancel_async(self);
+
+        switch (ret) {
         case CAT_RETURN_STATE_OK:
         case CAT_RETURN_STATE_DATA_OK:
                 ack_ok(self);
@@ -2158,6 +3828,9 @@ static cat_status process_write_loop(struct cat_object *self)
         case CAT_RETURN_STATE_HOLD:
                 enable_hold_state(self);
                 break;
+        case CAT_RETURN_STATE_ASYNC:
+                start_async(self);
+                break;
         case CAT_RETURN_STATE_HOLD_EXIT_OK:
         case CAT_RETURN_STATE_HOLD_EXIT_ERROR:
         case CAT_RETURN_STATE_ERROR:
@@ -2172,9 +3845,16 @@ static cat_status process_write_loop(struct cat_object *self)
 
 static cat_status process_run_loop(struct cat_object *self)
 {
+        cat_return_state ret;
+
         assert(self != NULL);
 
-        switch (self->cmd->run(self->cmd)) {
+        prepare_async(self);
+        ret = self->cmd->run(self->cmd);
+        if (ret != CAT_RETURN_STATE_ASYNC)
+                cancel_async(self);
+
+        switch (ret) {
         case CAT_RETURN_STATE_OK:
         case CAT_RETURN_STATE_DATA_OK:
                 ack_ok(self);
@@ -2185,6 +3865,9 @@ static cat_status process_run_loop(struct cat_object *self)
         case CAT_RETURN_STATE_HOLD:
                 enable_hold_state(self);
                 break;
+        case CAT_RETURN_STATE_ASYNC:
+                start_async(self);
+                break;
         case CAT_RETURN_STATE_PRINT_CMD_LIST_OK:
                 start_print_cmd_list(self);
                 break;
@@ -2210,7 +3893,7 @@ static cat_return_state call_cmd_read_by_fsm(struct cat_object *self, cat_fsm_ty
         case CAT_FSM_TYPE_ATCMD:
                 return cmd->read(cmd, (uint8_t*)get_atcmd_buf(self), &self->position, get_atcmd_buf_size(self));
         case CAT_FSM_TYPE_UNSOLICITED:
-                return cmd->read(cmd, (uint8_t*)get_unsolicited_buf(self), &self->unsolicited_fsm.position, get_unsolicited_buf_size(self));
+                return cmd->read(cmd, (uint8_t*)get_unsolicited_buf(self), &self->unsolicited_fsm->position, get_unsolicited_buf_size(self));
         default:
                 assert(false);
         }
@@ -2285,7 +3968,7 @@ static cat_return_state call_cmd_test_by_fsm(struct cat_object *self, cat_fsm_ty
         case CAT_FSM_TYPE_ATCMD:
                 return cmd->test(cmd, (uint8_t*)get_atcmd_buf(self), &self->position, get_atcmd_buf_size(self));
         case CAT_FSM_TYPE_UNSOLICITED:
-                return cmd->test(cmd, (uint8_t*)get_unsolicited_buf(self), &self->unsolicited_fsm.position, get_unsolicited_buf_size(self));
+                return cmd->test(cmd, (uint8_t*)get_unsolicited_buf(self), &self->unsolicited_fsm->position, get_unsolicited_buf_size(self));
         default:
                 assert(false);
         }
@@ -2378,26 +4061,70 @@ cat_status cat_hold_exit(struct cat_object *self, cat_status status)
 
         assert(self != NULL);
 
-        if ((self->mutex != NULL) && (self->mutex->lock() != 0))
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_LOCK;
 
         s = hold_exit(self, status);
 
-        if ((self->mutex != NULL) && (self->mutex->unlock() != 0))
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_UNLOCK;
 
         return s;
 }
 
+static size_t search_cmd_index_name(struct cat_object *self, const char *name)
+{
+        size_t begin = 0;
+        size_t end = self->commands_num;
+        size_t mid;
+
+        while (begin < end) {
+                mid = begin + ((end - begin) >> 1);
+                if (compare_cmd_names(self->desc->cmd_index[mid].cmd->name, name) < 0) {
+                        begin = mid + 1;
+                } else {
+                        end = mid;
+                }
+        }
+
+        return begin;
+}
+
 struct cat_command const* cat_search_command_by_name(struct cat_object *self, const char *name)
 {
         size_t i;
+        size_t name_len;
+        uint32_t hash;
         struct cat_command const *cmd;
 
         assert(self != NULL);
         assert(name != NULL);
 
+        if (self->desc->cmd_hash != NULL) {
+                hash = CAT_HASH_INIT;
+                for (i = 0; name[i] != '\0'; i++)
+                        hash = cat_hash_update(hash, name[i]);
+
+                cmd = get_command_by_index(self, get_cmd_hash_index(self, hash));
+                return (strcmp(cmd->name, name) == 0) ? cmd : NULL;
+        }
+
+        if (self->desc->cmd_index != NULL) {
+                for (i = search_cmd_index_name(self, name); i < self->commands_num; i++) {
+                        cmd = self->desc->cmd_index[i].cmd;
+                        if (compare_cmd_names(cmd->name, name) != 0)
+                                break;
+                        if (strcmp(cmd->name, name) == 0)
+                                return cmd;
+                }
+                return NULL;
+        }
+
+        name_len = strlen(name);
         for (i = 0; i < self->commands_num; i++) {
+                /* names with different length are rejected without touching command descriptor */
+                if ((self->desc->cmd_meta != NULL) && (self->desc->cmd_meta[i].name_len != name_len))
+                        continue;
                 cmd = get_command_by_index(self, i);
                 if (strcmp(cmd->name, name) == 0)
                         return cmd;
@@ -2444,87 +4171,332 @@ struct cat_variable const* cat_search_variable_by_name(struct cat_object *self,
 
 static cat_status process_io_write_wait(struct cat_object *self)
 {
-        if (self->unsolicited_fsm.state != CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE)
+        if ((self->unsolicited_fsm == NULL) || (self->unsolicited_fsm->state != CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE))
                 self->state = CAT_STATE_FLUSH_IO_WRITE;
 
         return CAT_STATUS_BUSY;
 }
 
-static cat_status unsolicited_process_io_write_wait(struct cat_object *self)
+static uint32_t get_unsolicited_rate_cost(struct cat_object *self)
 {
-        if (self->state != CAT_STATE_FLUSH_IO_WRITE)
-                self->unsolicited_fsm.state = CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE;
+        const char *buf = get_unsolicited_buf(self);
+        uint32_t cost = 0;
+        bool line_start = true;
+
+        if (self->desc->unsolicited_rate_unit == CAT_UNSOLICITED_RATE_UNIT_BYTE)
+                return strlen(buf) + 2 * strlen(get_new_line_chars(self));
+
+        for (; *buf != 0; buf++) {
+                if ((*buf == '\r') || (*buf == '\n')) {
+                        line_start = true;
+                } else if (line_start != false) {
+                        line_start = false;
+                        cost++;
+                }
+        }
 
-        return CAT_STATUS_BUSY;
+        return cost;
 }
 
-static cat_status process_io_write(struct cat_object *self)
+static bool take_unsolicited_rate_tokens(struct cat_object *self)
 {
-        char ch = self->write_buf[self->position];
+        struct cat_unsolicited_fsm *fsm = self->unsolicited_fsm;
+        uint64_t burst;
+        uint64_t cost;
+        uint32_t now;
 
-        if (ch == '\0') {
-                switch (self->write_state) {
-                case CAT_WRITE_STATE_BEFORE:
-                        self->position = 0;
-                        self->write_buf = get_atcmd_buf(self);
-                        self->write_state = CAT_WRITE_STATE_MAIN_BUFFER;
-                        break;
-                case CAT_WRITE_STATE_MAIN_BUFFER:
-                        self->position = 0;
-                        self->write_buf = get_new_line_chars(self);
-                        self->write_state = CAT_WRITE_STATE_AFTER;
-                        break;
-                case CAT_WRITE_STATE_AFTER:
-                        self->state = self->write_state_after;
-                        break;
-                default:
-                        break;
-                }
-                return CAT_STATUS_BUSY;
-        }
+        if ((self->desc->unsolicited_rate == 0) || (self->clock == NULL))
+                return true;
 
-        if (self->io->write(ch) != 1)
-                return CAT_STATUS_BUSY;
+        burst = (uint64_t)self->desc->unsolicited_rate_burst * 1000000U;
+        now = get_clock_time_us(self);
 
-        self->position++;
-        return CAT_STATUS_BUSY;
-}
+        /* bucket is full until first refill */
+        if (fsm->rate_time_valid == false) {
+                fsm->rate_time_valid = true;
+                fsm->rate_credit = burst;
+        } else {
+                fsm->rate_credit += (uint64_t)(uint32_t)(now - fsm->rate_time_us) * self->desc->unsolicited_rate;
+                if (fsm->rate_credit > burst)
+                        fsm->rate_credit = burst;
+        }
+        fsm->rate_time_us = now;
 
-static cat_status unsolicited_process_io_write(struct cat_object *self)
-{
-        char ch = self->unsolicited_fsm.write_buf[self->unsolicited_fsm.position];
+        cost = (uint64_t)get_unsolicited_rate_cost(self) * 1000000U;
+        if (cost > burst)
+                cost = burst;
 
-        if (ch == '\0') {
-                switch (self->unsolicited_fsm.write_state) {
-                case CAT_WRITE_STATE_BEFORE:
-                        self->unsolicited_fsm.position = 0;
-                        self->unsolicited_fsm.write_buf = get_unsolicited_buf(self);
-                        self->unsolicited_fsm.write_state = CAT_WRITE_STATE_MAIN_BUFFER;
-                        break;
-                case CAT_WRITE_STATE_MAIN_BUFFER:
-                        self->unsolicited_fsm.position = 0;
-                        self->unsolicited_fsm.write_buf = get_new_line_chars(self);
-                        self->unsolicited_fsm.write_state = CAT_WRITE_STATE_AFTER;
-                        break;
-                case CAT_WRITE_STATE_AFTER:
-                        self->unsolicited_fsm.state = self->unsolicited_fsm.write_state_after;
-                        break;
+        if (fsm->rate_credit < cost) {
+                if (fsm->rate_deferred == false) {
+                        fsm->rate_deferred = true;
+                        fsm->deferred_cntr++;
                 }
-                return CAT_STATUS_BUSY;
+                return false;
         }
 
-        if (self->io->write(ch) != 1)
-                return CAT_STATUS_BUSY;
+        fsm->rate_credit -= cost;
+        fsm->rate_deferred = false;
+        return true;
+}
+
+static cat_status unsolicited_process_io_write_wait(struct cat_object *self)
+{
+        /* response waiting for tokens leaves io free for command responses */
+        if ((self->state != CAT_STATE_FLUSH_IO_WRITE) && (take_unsolicited_rate_tokens(self) != false))
+                self->unsolicited_fsm->state = CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE;
 
-        self->unsolicited_fsm.position++;
         return CAT_STATUS_BUSY;
 }
 
-static cat_status unsolicited_events_service(struct cat_object *self)
+static size_t write_io_chars(struct cat_object *self, const char *buf)
 {
-        cat_status s = CAT_STATUS_OK;
-
-        switch (self->unsolicited_fsm.state) {
+        size_t len;
+        size_t n;
+
+        if (has_io_write_block(self->io) == false) {
+                if (io_write(self, buf[0]) == 1)
+                        return 1;
+
+                self->output_blocked_flag = true;
+                return 0;
+        }
+
+        /* whole rest of span is handed over, not accepted part is resumed in next call */
+        len = strlen(buf);
+        n = io_write_block(self, buf, len);
+        assert(n <= len);
+
+        if (n == 0)
+                self->output_blocked_flag = true;
+
+        return n;
+}
+
+static size_t write_io_vec(struct cat_object *self, const struct cat_io_vec *iov, size_t iov_num)
+{
+        size_t n;
+
+        if (iov_num == 0)
+                return 0;
+
+        n = io_write_iov(self, iov, iov_num);
+        if (n == 0)
+                self->output_blocked_flag = true;
+
+        return n;
+}
+
+static bool is_unsolicited_fsm_busy(struct cat_object *self)
+{
+        return (self->unsolicited_fsm != NULL) && (self->unsolicited_fsm->state != CAT_UNSOLICITED_STATE_IDLE);
+}
+
+static void add_io_vec(struct cat_io_vec *iov, size_t *iov_num, const char *str)
+{
+        size_t len = strlen(str);
+
+        if (len == 0)
+                return;
+
+        iov[*iov_num].base = str;
+        iov[*iov_num].len = len;
+        (*iov_num)++;
+}
+
+static void next_io_write_part(struct cat_object *self)
+{
+        switch (self->write_state) {
+        case CAT_WRITE_STATE_BEFORE:
+                self->position = 0;
+                self->write_buf = get_atcmd_buf(self);
+                self->write_state = CAT_WRITE_STATE_MAIN_BUFFER;
+                break;
+        case CAT_WRITE_STATE_MAIN_BUFFER:
+                self->position = 0;
+                self->write_buf = get_new_line_chars(self);
+                self->write_state = CAT_WRITE_STATE_AFTER;
+                break;
+        case CAT_WRITE_STATE_AFTER:
+                self->state = self->write_state_after;
+                break;
+        default:
+                break;
+        }
+}
+
+static size_t get_io_write_vec(struct cat_object *self, struct cat_io_vec *iov)
+{
+        size_t iov_num = 0;
+
+        add_io_vec(iov, &iov_num, &self->write_buf[self->position]);
+
+        switch (self->write_state) {
+        case CAT_WRITE_STATE_BEFORE:
+                add_io_vec(iov, &iov_num, get_atcmd_buf(self));
+                add_io_vec(iov, &iov_num, get_new_line_chars(self));
+                break;
+        case CAT_WRITE_STATE_MAIN_BUFFER:
+                add_io_vec(iov, &iov_num, get_new_line_chars(self));
+                break;
+        default:
+                break;
+        }
+
+        /* final acknowledge is appended, so whole response goes out within single call */
+        /* (only without pending unsolicited events, which are written before acknowledge) */
+        if ((self->write_state_after == CAT_STATE_AFTER_FLUSH_OK) && (is_unsolicited_fsm_busy(self) == false) &&
+            (is_unsolicited_buffer_empty(self) != false)) {
+                add_io_vec(iov, &iov_num, get_new_line_chars(self));
+                add_io_vec(iov, &iov_num, "OK");
+                add_io_vec(iov, &iov_num, get_new_line_chars(self));
+        }
+
+        return iov_num;
+}
+
+static void skip_io_written_chars(struct cat_object *self, size_t n)
+{
+        size_t len;
+
+        while (self->state == CAT_STATE_FLUSH_IO_WRITE) {
+                len = strlen(&self->write_buf[self->position]);
+                if (len == 0) {
+                        next_io_write_part(self);
+                        if ((self->state == CAT_STATE_AFTER_FLUSH_OK) && (n > 0)) {
+                                /* io is still owned by atcmd fsm, so acknowledge flush can continue without waiting */
+                                ack_ok(self);
+                                self->state = CAT_STATE_FLUSH_IO_WRITE;
+                        }
+                        continue;
+                }
+
+                if (n == 0)
+                        break;
+
+                if (len > n)
+                        len = n;
+                self->position += len;
+                n -= len;
+        }
+
+        assert(n == 0);
+}
+
+static cat_status process_io_write(struct cat_object *self)
+{
+        struct cat_io_vec iov[6];
+        size_t iov_num;
+        char ch;
+
+        if (has_io_write_iov(self->io) != false) {
+                iov_num = get_io_write_vec(self, iov);
+                skip_io_written_chars(self, write_io_vec(self, iov, iov_num));
+                return CAT_STATUS_BUSY;
+        }
+
+        ch = self->write_buf[self->position];
+        if (ch == '\0') {
+                next_io_write_part(self);
+                return CAT_STATUS_BUSY;
+        }
+
+        self->position += write_io_chars(self, &self->write_buf[self->position]);
+        return CAT_STATUS_BUSY;
+}
+
+static void unsolicited_next_io_write_part(struct cat_object *self)
+{
+        switch (self->unsolicited_fsm->write_state) {
+        case CAT_WRITE_STATE_BEFORE:
+                self->unsolicited_fsm->position = 0;
+                self->unsolicited_fsm->write_buf = get_unsolicited_buf(self);
+                self->unsolicited_fsm->write_state = CAT_WRITE_STATE_MAIN_BUFFER;
+                break;
+        case CAT_WRITE_STATE_MAIN_BUFFER:
+                self->unsolicited_fsm->position = 0;
+                self->unsolicited_fsm->write_buf = get_new_line_chars(self);
+                self->unsolicited_fsm->write_state = CAT_WRITE_STATE_AFTER;
+                break;
+        case CAT_WRITE_STATE_AFTER:
+                self->unsolicited_fsm->state = self->unsolicited_fsm->write_state_after;
+                break;
+        }
+}
+
+static size_t unsolicited_get_io_write_vec(struct cat_object *self, struct cat_io_vec *iov)
+{
+        size_t iov_num = 0;
+
+        add_io_vec(iov, &iov_num, &self->unsolicited_fsm->write_buf[self->unsolicited_fsm->position]);
+
+        switch (self->unsolicited_fsm->write_state) {
+        case CAT_WRITE_STATE_BEFORE:
+                add_io_vec(iov, &iov_num, get_unsolicited_buf(self));
+                add_io_vec(iov, &iov_num, get_new_line_chars(self));
+                break;
+        case CAT_WRITE_STATE_MAIN_BUFFER:
+                add_io_vec(iov, &iov_num, get_new_line_chars(self));
+                break;
+        default:
+                break;
+        }
+
+        return iov_num;
+}
+
+static void unsolicited_skip_io_written_chars(struct cat_object *self, size_t n)
+{
+        size_t len;
+
+        while (self->unsolicited_fsm->state == CAT_UNSOLICITED_STATE_FLUSH_IO_WRITE) {
+                len = strlen(&self->unsolicited_fsm->write_buf[self->unsolicited_fsm->position]);
+                if (len == 0) {
+                        unsolicited_next_io_write_part(self);
+                        continue;
+                }
+
+                if (n == 0)
+                        break;
+
+                if (len > n)
+                        len = n;
+                self->unsolicited_fsm->position += len;
+                n -= len;
+        }
+
+        assert(n == 0);
+}
+
+static cat_status unsolicited_process_io_write(struct cat_object *self)
+{
+        struct cat_io_vec iov[3];
+        size_t iov_num;
+        char ch;
+
+        if (has_io_write_iov(self->io) != false) {
+                iov_num = unsolicited_get_io_write_vec(self, iov);
+                unsolicited_skip_io_written_chars(self, write_io_vec(self, iov, iov_num));
+                return CAT_STATUS_BUSY;
+        }
+
+        ch = self->unsolicited_fsm->write_buf[self->unsolicited_fsm->position];
+        if (ch == '\0') {
+                unsolicited_next_io_write_part(self);
+                return CAT_STATUS_BUSY;
+        }
+
+        self->unsolicited_fsm->position += write_io_chars(self, &self->unsolicited_fsm->write_buf[self->unsolicited_fsm->position]);
+        return CAT_STATUS_BUSY;
+}
+
+static cat_status unsolicited_events_service(struct cat_object *self)
+{
+        cat_status s = CAT_STATUS_OK;
+
+        if (self->unsolicited_fsm == NULL)
+                return CAT_STATUS_OK;
+
+        switch (self->unsolicited_fsm->state) {
         case CAT_UNSOLICITED_STATE_IDLE:
                 check_unsolicited_buffers(self);
                 break;
@@ -2562,6 +4534,14 @@ static cat_status unsolicited_events_service(struct cat_object *self)
                 start_processing_format_test_args(self, CAT_FSM_TYPE_UNSOLICITED);
                 s = CAT_STATUS_BUSY;
                 break;
+        case CAT_UNSOLICITED_STATE_BATCH_NEXT_EVENT:
+                batch_next_unsolicited_event(self);
+                s = CAT_STATUS_BUSY;
+                break;
+        case CAT_UNSOLICITED_STATE_AFTER_FLUSH_RETRY:
+                start_unsolicited_event(self);
+                s = CAT_STATUS_BUSY;
+                break;
         default:
                 break;
         }
@@ -2569,23 +4549,30 @@ static cat_status unsolicited_events_service(struct cat_object *self)
         return s;
 }
 
-static bool is_unsolicited_fsm_busy(struct cat_object *self)
+static bool is_input_parsing_state(struct cat_object *self)
 {
-        return (self->unsolicited_fsm.state != CAT_UNSOLICITED_STATE_IDLE);
+        switch (self->state) {
+        case CAT_STATE_ERROR:
+        case CAT_STATE_PARSE_PREFIX:
+        case CAT_STATE_PARSE_COMMAND_CHAR:
+        case CAT_STATE_UPDATE_COMMAND_STATE:
+        case CAT_STATE_WAIT_READ_ACKNOWLEDGE:
+        case CAT_STATE_SEARCH_COMMAND:
+        case CAT_STATE_PARSE_COMMAND_ARGS:
+                return true;
+        default:
+                break;
+        }
+
+        return false;
 }
 
-cat_status cat_service(struct cat_object *self)
+static cat_status atcmd_service(struct cat_object *self)
 {
         cat_status s;
-        cat_status unsolicited_stat;
 
         assert(self != NULL);
 
-        if ((self->mutex != NULL) && (self->mutex->lock() != 0))
-                return CAT_STATUS_ERROR_MUTEX_LOCK;
-
-        unsolicited_stat = unsolicited_events_service(self);
-
         switch (self->state) {
         case CAT_STATE_ERROR:
                 s = error_state(self);
@@ -2675,11 +4662,296 @@ cat_status cat_service(struct cat_object *self)
                 break;
         }
 
+        return s;
+}
+
+static cat_status service_step(struct cat_object *self)
+{
+        cat_status s;
+        cat_status unsolicited_stat;
+
+        /* wait hint reflects only the last service step */
+        self->input_empty_flag = false;
+        self->output_blocked_flag = false;
+
+        unsolicited_stat = unsolicited_events_service(self);
+
+        s = atcmd_service(self);
+
+        /* rest of staged input block is parsed within the same call (stops before handlers and io writes) */
+        while ((s == CAT_STATUS_BUSY) && (is_input_staged(self) != false) && (is_input_parsing_state(self) != false))
+                s = atcmd_service(self);
+
+        if (self->input_ring_buf != NULL)
+                atomic_store_explicit(&self->ring_tail, self->ring_tail_local, memory_order_release);
+
+        release_line(self);
+
         if ((unsolicited_stat != CAT_STATUS_OK) || (is_unsolicited_fsm_busy(self) != false)) {
                 s = CAT_STATUS_BUSY;
         }
 
-        if ((self->mutex != NULL) && (self->mutex->unlock() != 0))
+        /* commands in flight still have responses to write */
+        if (self->async_tail != self->async_head)
+                s = CAT_STATUS_BUSY;
+
+        return s;
+}
+
+cat_status cat_service(struct cat_object *self)
+{
+        cat_status s;
+
+        assert(self != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        s = service_step(self);
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return s;
+}
+
+struct cat_service_snapshot {
+        cat_state state;
+        cat_unsolicited_state unsolicited_state;
+        size_t position;
+        size_t unsolicited_position;
+        size_t index;
+        size_t unsolicited_index;
+        size_t read_cntr;
+};
+
+static void take_service_snapshot(struct cat_object *self, struct cat_service_snapshot *snapshot)
+{
+        snapshot->state = self->state;
+        snapshot->position = self->position;
+        snapshot->index = self->index;
+        snapshot->read_cntr = self->read_cntr;
+
+        snapshot->unsolicited_state = CAT_UNSOLICITED_STATE_IDLE;
+        snapshot->unsolicited_position = 0;
+        snapshot->unsolicited_index = 0;
+        if (self->unsolicited_fsm != NULL) {
+                snapshot->unsolicited_state = self->unsolicited_fsm->state;
+                snapshot->unsolicited_position = self->unsolicited_fsm->position;
+                snapshot->unsolicited_index = self->unsolicited_fsm->index;
+        }
+}
+
+static bool is_service_snapshot_changed(struct cat_object *self, struct cat_service_snapshot const *snapshot)
+{
+        struct cat_service_snapshot current;
+
+        take_service_snapshot(self, &current);
+
+        return (current.state != snapshot->state) ||
+               (current.unsolicited_state != snapshot->unsolicited_state) ||
+               (current.position != snapshot->position) ||
+               (current.unsolicited_position != snapshot->unsolicited_position) ||
+               (current.index != snapshot->index) ||
+               (current.unsolicited_index != snapshot->unsolicited_index) ||
+               (current.read_cntr != snapshot->read_cntr);
+}
+
+cat_status cat_service_run(struct cat_object *self, size_t max_steps, size_t *steps)
+{
+        struct cat_service_snapshot snapshot;
+        cat_status s = CAT_STATUS_BUSY;
+        size_t n = 0;
+
+        assert(self != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        while (n < max_steps) {
+                take_service_snapshot(self, &snapshot);
+
+                s = service_step(self);
+                n++;
+
+                /* step without any observable change means waiting for io, hold exit or handler */
+                if ((s != CAT_STATUS_BUSY) || (is_service_snapshot_changed(self, &snapshot) == false))
+                        break;
+        }
+
+        if (steps != NULL)
+                *steps = n;
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return s;
+}
+
+static cat_wait_hint get_wait_hint(struct cat_object *self)
+{
+        bool async_stalled = (self->state == CAT_STATE_IDLE) && (is_async_stalled(self) != false);
+
+        if (self->output_blocked_flag != false)
+                return CAT_WAIT_HINT_OUTPUT;
+
+        /* completion is written as soon as parser is idle */
+        if ((self->state == CAT_STATE_IDLE) && (is_async_completion_ready(self) != false))
+                return CAT_WAIT_HINT_NONE;
+
+        /* at command fsm has still something to do */
+        if ((self->input_empty_flag == false) && (self->state != CAT_STATE_HOLD) && (async_stalled == false))
+                return CAT_WAIT_HINT_NONE;
+
+        if ((is_unsolicited_fsm_busy(self) != false) || (is_unsolicited_buffer_empty(self) == false))
+                return (self->unsolicited_fsm->rate_deferred != false) ? CAT_WAIT_HINT_RATE_LIMIT : CAT_WAIT_HINT_NONE;
+
+        if (self->state == CAT_STATE_HOLD)
+                return CAT_WAIT_HINT_HOLD;
+
+        return (async_stalled != false) ? CAT_WAIT_HINT_ASYNC : CAT_WAIT_HINT_INPUT;
+}
+
+cat_status cat_get_wait_hint(struct cat_object *self, cat_wait_hint *hint)
+{
+        assert(self != NULL);
+        assert(hint != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        *hint = get_wait_hint(self);
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return CAT_STATUS_OK;
+}
+
+cat_status cat_set_clock_interface(struct cat_object *self, const struct cat_clock_interface *clock)
+{
+        assert(self != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        self->clock = clock;
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return CAT_STATUS_OK;
+}
+
+cat_status cat_service_timed(struct cat_object *self, uint32_t budget_us)
+{
+        struct cat_service_snapshot snapshot;
+        cat_status s;
+        uint32_t start;
+        uint32_t step_start;
+        uint32_t now;
+
+        assert(self != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        /* budget cannot be measured without clock, nothing is serviced */
+        if (self->clock == NULL) {
+                if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                        return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+                return CAT_STATUS_ERROR;
+        }
+
+        start = get_clock_time_us(self);
+        now = start;
+
+        /* at least one step is done, even with zero budget */
+        do {
+                take_service_snapshot(self, &snapshot);
+
+                step_start = now;
+                s = service_step(self);
+                now = get_clock_time_us(self);
+
+                if ((uint32_t)(now - step_start) > self->stats.step_max_us)
+                        self->stats.step_max_us = now - step_start;
+
+                if ((s != CAT_STATUS_BUSY) || (is_service_snapshot_changed(self, &snapshot) == false))
+                        break;
+        } while ((uint32_t)(now - start) < budget_us);
+
+        if ((uint32_t)(now - start) > self->stats.slice_max_us)
+                self->stats.slice_max_us = now - start;
+        if ((uint32_t)(now - start) > budget_us)
+                self->stats.overrun_cntr++;
+        self->stats.slice_cntr++;
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return s;
+}
+
+cat_status cat_get_service_stats(struct cat_object *self, struct cat_service_stats *stats, bool clear)
+{
+        assert(self != NULL);
+        assert(stats != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        *stats = self->stats;
+        if (clear != false)
+                memset(&self->stats, 0, sizeof(self->stats));
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_UNLOCK;
+
+        return CAT_STATUS_OK;
+}
+
+cat_status cat_process_line(struct cat_object *self, const char *line, size_t len)
+{
+        struct cat_service_snapshot snapshot;
+        cat_status s;
+
+        assert(self != NULL);
+        assert(line != NULL);
+
+        if ((self->mutex != NULL) && (lock_mutex(self) != 0))
+                return CAT_STATUS_ERROR_MUTEX_LOCK;
+
+        if ((self->state == CAT_STATE_IDLE) && (self->line == NULL)) {
+                if ((len > 0) && (line[len - 1] == '\n'))
+                        len--;
+
+                self->line = line;
+                self->line_len = len;
+                self->line_pos = 0;
+
+                /* whole line is parsed and its responses flushed within this call, */
+                /* unless parser stops making progress (then cat_service continues from the same state) */
+                do {
+                        take_service_snapshot(self, &snapshot);
+                        unsolicited_events_service(self);
+                        atcmd_service(self);
+                        if (is_service_snapshot_changed(self, &snapshot) == false)
+                                break;
+                } while (((self->state != CAT_STATE_IDLE) || (is_line_consumed(self) == false)) && (self->state != CAT_STATE_HOLD));
+
+                release_line(self);
+
+                if (self->state == CAT_STATE_HOLD) {
+                        s = CAT_STATUS_HOLD;
+                } else {
+                        s = (self->line == NULL) ? CAT_STATUS_OK : CAT_STATUS_BUSY;
+                }
+        } else {
+                s = (self->state == CAT_STATE_HOLD) ? CAT_STATUS_HOLD : CAT_STATUS_ERROR_BUFFER_FULL;
+        }
+
+        if ((self->mutex != NULL) && (unlock_mutex(self) != 0))
                 return CAT_STATUS_ERROR_MUTEX_UNLOCK;
 
         return s;
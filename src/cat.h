@@ -25,20 +25,33 @@ SOFTWARE.
 #ifndef CAT_H
 #define CAT_H
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
 
+#ifdef __cplusplus
+/* C++ has no _Atomic types, layout compatible std::atomic types are used instead (the same as C++23 stdatomic.h) */
+#include <atomic>
+using std::atomic_size_t;
+using std::atomic_uchar;
+#else
+#include <stdatomic.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* only forward declarations (looks for definition below) */
 struct cat_command;
 struct cat_variable;
+struct cat_unsolicited_cmd;
+struct cat_unsolicited_fsm;
+struct cat_async_completion;
 
 #ifndef CAT_UNSOLICITED_CMD_BUFFER_SIZE
 /* unsolicited command buffer default size (can by override externally during compilation) */
+/* used only by objects without unsolicited commands buffer configured in descriptor */
 #define CAT_UNSOLICITED_CMD_BUFFER_SIZE     ((size_t)(1))
 #endif
 
@@ -60,6 +73,7 @@ typedef enum {
 
 /* enum type with function status */
 typedef enum {
+        CAT_STATUS_ERROR_NOT_PENDING = -8,
         CAT_STATUS_ERROR_BUFFER_EMPTY = -7,
         CAT_STATUS_ERROR_NOT_HOLD = -6,
         CAT_STATUS_ERROR_BUFFER_FULL = -5,
@@ -119,6 +133,7 @@ typedef enum {
         CAT_RETURN_STATE_HOLD_EXIT_OK, /* exit from hold state with OK response */
         CAT_RETURN_STATE_HOLD_EXIT_ERROR, /* exit from hold state with ERROR response */
         CAT_RETURN_STATE_PRINT_CMD_LIST_OK, /* print commands list followed by ok acknowledge (only in TEST and RUN) */
+        CAT_RETURN_STATE_ASYNC, /* command is in flight, response is posted later by cat_async_complete (only in WRITE and RUN) */
 } cat_return_state;
 
 /**
@@ -224,16 +239,84 @@ typedef enum {
         CAT_CMD_TYPE__TOTAL_NUM
 } cat_cmd_type;
 
+/* structure with output vector entry (layout compatible with posix struct iovec) */
+struct cat_io_vec {
+        void const *base; /* pointer to data to write */
+        size_t len; /* length of data to write */
+};
+
 /* structure with io interface functions */
 struct cat_io_interface {
         int (*write)(char ch); /* write char to output stream. return 1 if byte wrote successfully. */
         int (*read)(char *ch); /* read char from input stream. return 1 if byte read successfully. */
+
+        /* optional block read, if not configured (NULL) then input is read char by char */
+        size_t (*read_block)(char *buf, size_t max_size); /* read up to max_size bytes from input stream. return number of read bytes. */
+
+        /* optional block write, if not configured (NULL) then output is written char by char */
+        size_t (*write_block)(const char *buf, size_t len); /* write up to len bytes to output stream. return number of accepted bytes. */
+
+        /* optional vectored write, if configured then it is used instead of write_block and write */
+        size_t (*write_iov)(const struct cat_io_vec *iov, size_t iov_num); /* write vectors to output stream in order. return number of accepted bytes. */
+
+        /* optional context carrying variants, if configured (not NULL) then they are used instead of plain handlers */
+        /* so single io implementation can serve many parser objects (every object has own interface with own ctx) */
+        void *ctx; /* user context passed to every context carrying handler */
+        int (*write_ctx)(void *ctx, char ch); /* like write */
+        int (*read_ctx)(void *ctx, char *ch); /* like read */
+        size_t (*read_block_ctx)(void *ctx, char *buf, size_t max_size); /* like read_block */
+        size_t (*write_block_ctx)(void *ctx, const char *buf, size_t len); /* like write_block */
+        size_t (*write_iov_ctx)(void *ctx, const struct cat_io_vec *iov, size_t iov_num); /* like write_iov */
 };
 
 /* structure with mutex interface functions */
 struct cat_mutex_interface {
         int (*lock)(void); /* lock mutex handler. return 0 if successfully locked, otherwise - cannot lock */
         int (*unlock)(void); /* unlock mutex handler. return 0 if successfully unlocked, otherwise - cannot unlock */
+
+        /* optional context carrying variants, if configured (not NULL) then they are used instead of plain handlers */
+        void *ctx; /* user context passed to every context carrying handler */
+        int (*lock_ctx)(void *ctx); /* like lock */
+        int (*unlock_ctx)(void *ctx); /* like unlock */
+};
+
+/* structure with clock interface functions */
+struct cat_clock_interface {
+        uint32_t (*get_time_us)(void); /* return monotonic time in microseconds (wrapping around is allowed) */
+
+        /* optional context carrying variant, if configured (not NULL) then it is used instead of plain handler */
+        void *ctx; /* user context passed to context carrying handler */
+        uint32_t (*get_time_us_ctx)(void *ctx); /* like get_time_us */
+};
+
+/* structure with timed service statistics */
+struct cat_service_stats {
+        uint32_t slice_max_us; /* worst-case duration of single timed service call */
+        uint32_t step_max_us; /* worst-case duration of single service step */
+        uint32_t slice_cntr; /* number of timed service calls */
+        uint32_t overrun_cntr; /* number of timed service calls exceeding time budget */
+};
+
+/* enum type with reason of parser waiting after service call (what event host loop can sleep on) */
+typedef enum {
+        CAT_WAIT_HINT_NONE = 0, /* parser can make progress, service should be called again */
+        CAT_WAIT_HINT_INPUT, /* parser waits for input chars */
+        CAT_WAIT_HINT_OUTPUT, /* io write did not accept any data (wait until output is writable) */
+        CAT_WAIT_HINT_HOLD, /* parser waits in hold state (for cat_hold_exit or unsolicited event) */
+        CAT_WAIT_HINT_RATE_LIMIT, /* unsolicited response waits for rate limit tokens (wait some time) */
+        CAT_WAIT_HINT_ASYNC, /* parser waits for asynchronous completions (limit of commands in flight reached) */
+} cat_wait_hint;
+
+/* enum type with unsolicited output rate limit token unit */
+typedef enum {
+        CAT_UNSOLICITED_RATE_UNIT_BYTE = 0, /* single token per written byte (together with new line chars) */
+        CAT_UNSOLICITED_RATE_UNIT_LINE, /* single token per written non-empty response line */
+} cat_unsolicited_rate_unit;
+
+/* structure with unsolicited events output statistics */
+struct cat_unsolicited_rate_stats {
+        size_t deferred_cntr; /* number of responses which waited for rate limit tokens */
+        size_t dropped_cntr; /* number of events rejected because unsolicited commands buffer was full */
 };
 
 /* structure with at command descriptor */
@@ -264,6 +347,31 @@ struct cat_command_group {
         bool disable; /* flag to completely disable all commands in group */
 };
 
+/* structure with commands index entry (filled and sorted by command name in cat_init) */
+struct cat_command_index {
+        struct cat_command const *cmd; /* pointer to indexed command descriptor */
+        size_t index; /* global command index (commands registration order) */
+};
+
+/* structure with command name metadata (filled in cat_init) */
+struct cat_command_meta {
+        char const *name; /* pointer to upper-cased copy of command name */
+        size_t name_len; /* command name length */
+        char first_char; /* upper-cased first char of command name (first matching step bucket) */
+};
+
+/* initial value of command name hash (see cat_hash_update) */
+#define CAT_HASH_INIT ((uint32_t)2166136261U)
+
+/* structure with minimal perfect hash commands table (generated offline by cat-gen tool) */
+struct cat_command_hash {
+        uint32_t const *seed; /* pointer to array of buckets displacement seeds */
+        size_t seed_num; /* number of buckets */
+        size_t const *index; /* pointer to array of global command indexes for every hash slot */
+        char const * const *name; /* pointer to array of upper-cased command names in global command index order */
+        size_t num; /* number of hash slots (equal to total number of commands) */
+};
+
 /* structure with at command parser descriptor */
 struct cat_descriptor {
         struct cat_command_group* const *cmd_group; /* pointer to array of commands group descriptor */
@@ -276,12 +384,153 @@ struct cat_descriptor {
         /* then the buf will be divided into two smaller buffers */
         uint8_t *unsolicited_buf; /* pointer to unsolicited working buffer (used to parse command argument) */
         size_t unsolicited_buf_size; /* unsolicited working buffer length */
+
+        /* optional commands index, if not configured (NULL) */
+        /* then commands are matched by scanning all registered commands */
+        struct cat_command_index *cmd_index; /* pointer to commands index array (at least total number of commands) */
+        size_t cmd_index_num; /* commands index array length */
+
+        /* optional perfect hash commands table generated by cat-gen tool, requires commands index */
+        /* (name chars are matched by index, full matched name is resolved by hash in constant time) */
+        struct cat_command_hash const *cmd_hash; /* pointer to commands hash table */
+
+        /* optional flat commands table, if not configured (NULL) */
+        /* then commands groups are walked on every access to command by its global index */
+        struct cat_command const **cmd_table; /* pointer to array of commands pointers (filled in cat_init) */
+        size_t cmd_table_num; /* commands table length (at least total number of commands) */
+
+        /* optional disabled commands bitmap, if not configured (NULL) */
+        /* then disable flags of groups and commands are checked on every access */
+        /* bitmap is filled in cat_init and must be refreshed by cat_update_disable_state after flags change */
+        uint8_t *cmd_disable_buf; /* pointer to disabled commands bitmap buffer */
+        size_t cmd_disable_buf_size; /* disabled commands bitmap buffer size (at least one bit per command) */
+
+        /* optional commands names metadata, if not configured (NULL) */
+        /* then names lengths and upper-cased chars are computed on every received char */
+        /* names buffer is not needed when commands hash table is configured (its names are reused) */
+        struct cat_command_meta *cmd_meta; /* pointer to commands metadata array (filled in cat_init) */
+        size_t cmd_meta_num; /* commands metadata array length (at least total number of commands) */
+        char *cmd_name_buf; /* pointer to upper-cased commands names buffer */
+        size_t cmd_name_buf_size; /* names buffer size (at least sum of names lengths with terminators) */
+
+        /* optional live candidates list, if not configured (NULL) */
+        /* then every registered command is checked against matching bitmap on every received char */
+        size_t *cmd_candidate; /* pointer to candidates indexes array (at least total number of commands) */
+        size_t cmd_candidate_num; /* candidates indexes array length */
+
+        /* optional input ring buffer filled by cat_feed_input, if configured then it replaces io read functions */
+        char *input_ring_buf; /* pointer to input ring buffer */
+        size_t input_ring_size; /* input ring buffer size (power of two) */
+
+        /* optional unsolicited events fsm storage, if not configured (NULL) */
+        /* then unsolicited events are not supported (and unsolicited buffers below are not used) */
+        struct cat_unsolicited_fsm *unsolicited_fsm; /* pointer to unsolicited events fsm state and queues */
+
+        /* optional unsolicited commands buffer, if not configured (NULL) */
+        /* then internal buffer with CAT_UNSOLICITED_CMD_BUFFER_SIZE items is used */
+        struct cat_unsolicited_cmd *unsolicited_cmd_buf; /* pointer to unsolicited commands array (events queue storage) */
+        size_t unsolicited_cmd_buf_num; /* unsolicited commands array length (maximum number of buffered events) */
+
+        /* optional unsolicited commands buffers of low and high priority events, if not configured (NULL) */
+        /* then events of such priority are buffered together with normal priority events */
+        struct cat_unsolicited_cmd *unsolicited_low_cmd_buf; /* pointer to low priority unsolicited commands array */
+        size_t unsolicited_low_cmd_buf_num; /* low priority unsolicited commands array length */
+        struct cat_unsolicited_cmd *unsolicited_high_cmd_buf; /* pointer to high priority unsolicited commands array */
+        size_t unsolicited_high_cmd_buf_num; /* high priority unsolicited commands array length */
+
+        /* optional unsolicited events payload arena, if not configured (NULL) */
+        /* then snapshot events (see cat_trigger_unsolicited_snapshot) cannot be triggered */
+        /* arena is divided into fixed size slots, one slot per every unsolicited commands buffers item */
+        char *unsolicited_arena_buf; /* pointer to payload arena */
+        size_t unsolicited_arena_buf_size; /* payload arena size (at least slot size * total number of unsolicited commands buffers items) */
+        size_t unsolicited_arena_slot_size; /* payload slot size (maximum response length with terminator, not greater than unsolicited buffer) */
+
+        /* unsolicited events batching, if enabled then queued events are formatted one after another */
+        /* into unsolicited buffer (as many as fit) and flushed together within single io write transaction */
+        /* event which does not fit into rest of buffer is formatted again (alone) after batch flush */
+        bool unsolicited_batch;
+
+        /* optional unsolicited output rate limit (token bucket refilled using clock interface), if rate is zero */
+        /* or clock interface is not attached then unsolicited responses are written as soon as io is free */
+        /* response waiting for tokens does not hold io, so command responses are not delayed */
+        uint32_t unsolicited_rate; /* bucket refill rate (tokens per second) */
+        uint32_t unsolicited_rate_burst; /* bucket capacity (response costing more waits for full bucket) */
+        cat_unsolicited_rate_unit unsolicited_rate_unit; /* meaning of single token */
+
+        /* optional commands address index (open addressing hash of commands pointers filled in cat_init), */
+        /* required by unsolicited pending events bitmap to resolve index of triggered command in constant time */
+        struct cat_command_index *cmd_addr_index; /* pointer to address index array */
+        size_t cmd_addr_index_num; /* address index array length (power of two, at least twice total number of commands) */
+
+        /* optional unsolicited pending events bitmap (one bit per command, type and priority), if not configured (NULL) */
+        /* then every triggered event is buffered, even if identical event is already pending */
+        /* events of commands registered in commands groups are coalesced with pending ones of the same priority queue */
+        /* (commands address index is required) */
+        atomic_uchar *unsolicited_pending_buf; /* pointer to pending events bitmap */
+        size_t unsolicited_pending_buf_size; /* pending events bitmap size (at least CAT_UNSOLICITED_PENDING_BUF_SIZE(total number of commands) bytes) */
+
+        /* input staging buffer, required only when io read_block is configured */
+        char *input_buf; /* pointer to input block buffer */
+        size_t input_buf_size; /* input block buffer size (maximum length of single read block) */
+
+        /* optional asynchronous completions buffer, if not configured (NULL) */
+        /* then write and run handlers cannot return CAT_RETURN_STATE_ASYNC (command ends with error) */
+        /* its length limits number of commands in flight (next command is not parsed until oldest completion is drained) */
+        struct cat_async_completion *async_buf; /* pointer to completions array (completions queue storage) */
+        size_t async_buf_num; /* completions array length (maximum number of commands in flight) */
+
+        /* optional completions payload arena, if not configured (NULL) then completions cannot carry response data */
+        /* arena is divided into fixed size slots, one slot per every completions buffer item */
+        char *async_arena_buf; /* pointer to payload arena */
+        size_t async_arena_buf_size; /* payload arena size (at least slot size * completions array length) */
+        size_t async_arena_slot_size; /* payload slot size (maximum response length with terminator, not greater than atcmd buffer) */
+};
+
+/* structure with asynchronous command completion infos (one cell per pending token) */
+struct cat_async_completion {
+        struct cat_command const *cmd; /* pointer to command in flight */
+        bool cr_flag; /* new line chars of command request (used by its response) */
+        bool error; /* completion is acknowledged with ERROR instead of OK */
+        bool data; /* completion response was copied into payload arena slot */
+        bool discard; /* completion is dropped, handler answered synchronously after worker claimed token (written only by parser) */
+        atomic_size_t sequence; /* cell sequence number (free, pending, claimed by worker, completed), synchronizes worker with parser */
 };
 
 /* strcuture with unsolicited command buffered infos */
 struct cat_unsolicited_cmd {
         struct cat_command const *cmd; /* pointer to commands used to unsolicited event */
         cat_cmd_type type; /* type of unsolicited event */
+        bool snapshot; /* event response was formatted at trigger time into payload arena slot */
+        bool skip; /* cell carries no event (snapshot was not formatted) */
+        size_t pending_bit; /* pending events bitmap bit of event plus one (zero if event is not coalesced) */
+        atomic_size_t sequence; /* cell sequence number, synchronizes producers with consumer */
+};
+
+/* enum type with unsolicited events priority classes (higher value is drained first) */
+typedef enum {
+        CAT_UNSOLICITED_PRIORITY_LOW = 0,
+        CAT_UNSOLICITED_PRIORITY_NORMAL,
+        CAT_UNSOLICITED_PRIORITY_HIGH,
+        CAT_UNSOLICITED_PRIORITY__TOTAL_NUM
+} cat_unsolicited_priority;
+
+/* size in bytes of unsolicited pending events bitmap for given number of commands */
+#define CAT_UNSOLICITED_PENDING_BUF_SIZE(cmd_num) (((size_t)(cmd_num) * 2U * CAT_UNSOLICITED_PRIORITY__TOTAL_NUM + 7U) / 8U)
+
+/* structure with lock-free queue of unsolicited events of single priority */
+struct cat_unsolicited_queue {
+        struct cat_unsolicited_cmd *buf; /* pointer to queue storage (NULL if priority shares normal priority queue) */
+        size_t buf_num; /* queue storage length */
+        atomic_size_t tail; /* tail position of queue (reserved by producers) */
+        atomic_size_t head; /* head position of queue (advanced only by consumer) */
+        atomic_size_t high_water_mark; /* maximum number of buffered events */
+};
+
+/* structure with unsolicited events queue statistics */
+struct cat_unsolicited_queue_stats {
+        size_t depth; /* number of currently buffered events */
+        size_t high_water_mark; /* maximum number of buffered events since init or last clear */
+        size_t capacity; /* maximum number of buffered events */
 };
 
 /* enum type with unsolicited events fsm state */
@@ -297,6 +546,8 @@ typedef enum {
         CAT_UNSOLICITED_STATE_AFTER_FLUSH_OK,
         CAT_UNSOLICITED_STATE_AFTER_FLUSH_FORMAT_READ_ARGS,
         CAT_UNSOLICITED_STATE_AFTER_FLUSH_FORMAT_TEST_ARGS,
+        CAT_UNSOLICITED_STATE_BATCH_NEXT_EVENT,
+        CAT_UNSOLICITED_STATE_AFTER_FLUSH_RETRY,
 } cat_unsolicited_state;
 
 /* enum type with fsm type */
@@ -306,54 +557,154 @@ typedef enum {
         CAT_FSM_TYPE__TOTAL_NUM,
 } cat_fsm_type;
 
+/* structure with unsolicited events fsm state and queues (optional storage referenced by parser object) */
 struct cat_unsolicited_fsm {
-        cat_unsolicited_state state; /* current unsolicited fsm state */
-
         size_t index; /* index used to iterate over commands and variables */
         size_t position; /* position of actually parsed char in arguments string */
 
         struct cat_command const *cmd; /* pointer to current command descriptor */
         struct cat_variable const *var; /* pointer to current variable descriptor */
-        cat_cmd_type cmd_type; /* type of command request */
 
         char const *write_buf; /* working buffer pointer used for asynch writing to io */
+
+        uint64_t rate_credit; /* rate limit tokens scaled by one million (token per microsecond resolution) */
+        size_t deferred_cntr; /* number of responses which waited for rate limit tokens */
+        atomic_size_t dropped_cntr; /* number of events rejected because unsolicited commands buffer was full */
+
+        char *arena; /* pointer to payload slots of queue items (NULL if snapshot events are not supported) */
+
+        /* small fields are kept together, so they are packed without padding */
+        cat_unsolicited_state state; /* current unsolicited fsm state */
+        cat_cmd_type cmd_type; /* type of command request */
         int write_state; /* before, data, after flush io write state */
         cat_unsolicited_state write_state_after; /* parser state to set after flush io write */
+        uint32_t rate_time_us; /* time of last rate limit tokens refill */
+        uint32_t arena_slot_size; /* payload slot size of snapshot events */
+        uint32_t batch_len; /* length of already formatted responses waiting for batched flush */
+        uint32_t batch_offset; /* offset of currently formatted response in unsolicited buffer */
+        bool snapshot; /* current event response was formatted at trigger time */
+        bool rate_time_valid; /* flag of valid last refill time (false until first refill) */
+        bool rate_deferred; /* current response already waited for tokens (counted as deferred) */
+
+        struct cat_unsolicited_cmd unsolicited_cmd_buffer[CAT_UNSOLICITED_CMD_BUFFER_SIZE]; /* internal buffer with unsolicited commands used to unsolicited event */
+        struct cat_unsolicited_queue queue[CAT_UNSOLICITED_PRIORITY__TOTAL_NUM]; /* unsolicited events queues of every priority */
+};
+
+/* structure with commands table shared by many parser objects (built once by cat_table_init) */
+struct cat_table {
+        struct cat_descriptor const *desc; /* pointer to shared descriptor (commands groups and derived commands tables) */
+        size_t commands_num; /* computed total number of registered commands */
+        size_t cmd_index_last; /* commands index entry of last registered command */
+};
+
+/* structure with per session storage (buffers which cannot be shared between parser objects) */
+/* every buffer except working buffer is optional and has the same meaning as in descriptor */
+struct cat_session_config {
+        uint8_t *buf; /* pointer to working buffer (used to parse command argument) */
+        size_t buf_size; /* working buffer length */
+
+        uint8_t *unsolicited_buf; /* pointer to unsolicited working buffer (NULL to divide working buffer into two parts) */
+        size_t unsolicited_buf_size; /* unsolicited working buffer length */
+
+        size_t *cmd_candidate; /* pointer to live candidates indexes array (at least total number of commands) */
+        size_t cmd_candidate_num; /* candidates indexes array length */
+
+        char *input_ring_buf; /* pointer to input ring buffer filled by cat_feed_input */
+        size_t input_ring_size; /* input ring buffer size (power of two) */
+
+        char *input_buf; /* pointer to input block buffer (required only when io read_block is configured) */
+        size_t input_buf_size; /* input block buffer size */
 
-        struct cat_unsolicited_cmd unsolicited_cmd_buffer[CAT_UNSOLICITED_CMD_BUFFER_SIZE]; /* buffer with unsolicited commands used to unsolicited event */
-        size_t unsolicited_cmd_buffer_tail; /* tail index of unsolicited cmd buffer */
-        size_t unsolicited_cmd_buffer_head; /* head index of unsolicited cmd buffer */
-        size_t unsolicited_cmd_buffer_items_count; /* number of unsolicited cmd in buffer */
+        struct cat_unsolicited_fsm *unsolicited_fsm; /* pointer to unsolicited events fsm storage (NULL if unsolicited events are not used) */
+        struct cat_unsolicited_cmd *unsolicited_cmd_buf; /* pointer to unsolicited commands array (NULL to use internal buffer) */
+        size_t unsolicited_cmd_buf_num; /* unsolicited commands array length */
+        struct cat_unsolicited_cmd *unsolicited_low_cmd_buf; /* pointer to low priority unsolicited commands array */
+        size_t unsolicited_low_cmd_buf_num; /* low priority unsolicited commands array length */
+        struct cat_unsolicited_cmd *unsolicited_high_cmd_buf; /* pointer to high priority unsolicited commands array */
+        size_t unsolicited_high_cmd_buf_num; /* high priority unsolicited commands array length */
+
+        char *unsolicited_arena_buf; /* pointer to unsolicited events payload arena */
+        size_t unsolicited_arena_buf_size; /* payload arena size */
+        size_t unsolicited_arena_slot_size; /* payload slot size */
+
+        atomic_uchar *unsolicited_pending_buf; /* pointer to pending events bitmap (commands address index is required in descriptor) */
+        size_t unsolicited_pending_buf_size; /* pending events bitmap size */
+
+        struct cat_async_completion *async_buf; /* pointer to asynchronous completions array */
+        size_t async_buf_num; /* completions array length */
+        char *async_arena_buf; /* pointer to completions payload arena */
+        size_t async_arena_buf_size; /* payload arena size */
+        size_t async_arena_slot_size; /* payload slot size */
 };
 
 /* structure with main at command parser object */
 struct cat_object {
-        struct cat_descriptor const *desc; /* pointer to at command parser descriptor */
+        struct cat_descriptor const *desc; /* pointer to at command parser descriptor (commands and shared tables) */
         struct cat_io_interface const *io; /* pointer to at command parser io interface */
         struct cat_mutex_interface const *mutex; /* pointer to at command parser mutex interface */
+        struct cat_clock_interface const *clock; /* pointer to at command parser clock interface (optional) */
+        struct cat_service_stats stats; /* timed service statistics */
+
+        /* per session storage taken from session config (or from descriptor by cat_init) */
+        uint8_t *buf; /* pointer to atcmd working buffer */
+        char *unsolicited_buf; /* pointer to unsolicited working buffer (separate buffer or second half of working buffer) */
+        size_t *cmd_candidate; /* pointer to live candidates list (optional) */
+        char *input_ring_buf; /* pointer to input ring buffer (optional) */
+        char *input_buf; /* pointer to input block buffer (optional) */
+        atomic_uchar *unsolicited_pending_buf; /* pointer to pending events bitmap (optional) */
+        struct cat_async_completion *async_buf; /* pointer to asynchronous completions array (optional) */
+        char *async_arena_buf; /* pointer to completions payload arena (optional) */
+        struct cat_unsolicited_fsm *unsolicited_fsm; /* pointer to unsolicited events fsm storage (optional) */
 
         size_t index; /* index used to iterate over commands and variables */
-        size_t partial_cntr; /* partial match commands counter */
         size_t length; /* length of input command name and command arguments */
         size_t position; /* position of actually parsed char in arguments string */
         size_t write_size; /* size of parsed buffer hex or buffer string */
-        size_t commands_num; /* computed total number of registered commands */
+        size_t read_cntr; /* number of chars read from input (used to detect service progress) */
+        atomic_size_t ring_head; /* input ring write index (free running, owned by cat_feed_input producer) */
+        atomic_size_t ring_tail; /* input ring read index (free running, published by parser consumer) */
+        size_t ring_head_cache; /* last seen input ring write index (consumer side) */
+        size_t ring_tail_local; /* not yet published input ring read index (consumer side) */
+        char const *line; /* pointer to line processed by cat_process_line (NULL when input is read from io) */
+        size_t line_len; /* length of processed line */
+        size_t line_pos; /* position of next char to parse in processed line */
+        char const *args; /* pointer to write arguments parsed in place (NULL when arguments are copied to working buffer) */
 
         struct cat_command const *cmd; /* pointer to current command descriptor */
         struct cat_variable const *var; /* pointer to current variable descriptor */
-        cat_cmd_type cmd_type; /* type of command request */
+        char const *write_buf; /* working buffer pointer used for asynch writing to io */
 
-        char current_char; /* current received char from input stream */
+        size_t async_tail; /* pending token of next asynchronous command (owned by parser) */
+        size_t async_head; /* oldest pending token, its response is written first (owned by parser) */
+
+        /* small fields are kept together, so they are packed without padding */
+        /* session buffers sizes and commands indexes are limited to 32 bits (asserted at init) */
+        uint32_t buf_size; /* atcmd working buffer length */
+        uint32_t unsolicited_buf_size; /* unsolicited working buffer length */
+        uint32_t input_ring_size; /* input ring buffer size */
+        uint32_t input_buf_size; /* input block buffer size */
+        uint32_t async_buf_num; /* completions array length */
+        uint32_t async_arena_slot_size; /* completions payload slot size */
+        uint32_t commands_num; /* computed total number of registered commands */
+        uint32_t cmd_index_last; /* commands index entry of last registered command */
+        uint32_t cmd_index_begin; /* first commands index entry matching to parsed command name */
+        uint32_t cmd_index_end; /* end of commands index entries matching to parsed command name */
+        uint32_t candidate_num; /* number of commands still matching to parsed command name (live candidates list) */
+        uint32_t partial_cntr; /* partial match commands counter */
+        uint32_t input_pos; /* position of next char to parse in input block buffer */
+        uint32_t input_len; /* number of valid chars in input block buffer */
+        uint32_t name_hash; /* hash of parsed command name */
+        cat_cmd_type cmd_type; /* type of command request */
         cat_state state; /* current fsm state */
-        bool cr_flag; /* flag for detect <cr> char in input string */
-        bool hold_state_flag; /* status of hold state (independent from fsm states) */
         int hold_exit_status; /* hold exit parameter with status */
-        char const *write_buf; /* working buffer pointer used for asynch writing to io */
         int write_state; /* before, data, after flush io write state */
         cat_state write_state_after; /* parser state to set after flush io write */
+        char current_char; /* current received char from input stream */
+        bool cr_flag; /* flag for detect <cr> char in input string */
+        bool hold_state_flag; /* status of hold state (independent from fsm states) */
         bool implicit_write_flag; /* flag that implicit write was detected */
-
-        struct cat_unsolicited_fsm unsolicited_fsm;
+        bool input_empty_flag; /* input read returned no char in last service step */
+        bool output_blocked_flag; /* io write accepted no data in last service step */
 };
 
 /**
@@ -367,6 +718,32 @@ struct cat_object {
  */
 void cat_init(struct cat_object *self, const struct cat_descriptor *desc, const struct cat_io_interface *io, const struct cat_mutex_interface *mutex);
 
+/**
+ * Function used to build commands table shared by many parser objects (sessions).
+ * Commands are validated and descriptor derived tables (index, flat table, names metadata
+ * and disabled commands bitmap) are filled only once.
+ * Shared descriptor cannot contain per object storage (working buffers, input buffers,
+ * unsolicited commands buffers, payload arenas, pending events bitmap, candidates list
+ * and asynchronous completions buffer), every session takes it from own session config.
+ * 
+ * @param table pointer to shared commands table to initialize
+ * @param desc pointer to shared at command parser descriptor
+ */
+void cat_table_init(struct cat_table *table, const struct cat_descriptor *desc);
+
+/**
+ * Function used to initialize at command parser session using shared commands table.
+ * Per session buffers are taken from session config, config structure itself is not
+ * referenced after init (it can be temporary), but configured buffers must stay valid.
+ * 
+ * @param self pointer to at command parser object to initialize
+ * @param table pointer to shared commands table (built by cat_table_init)
+ * @param config pointer to session config with per session buffers
+ * @param io pointer to at command parser io low-level layer interface
+ * @param mutex pointer to at command partes mutex interface
+ */
+void cat_init_session(struct cat_object *self, const struct cat_table *table, const struct cat_session_config *config, const struct cat_io_interface *io, const struct cat_mutex_interface *mutex);
+
 /**
  * Function must be called periodically to asynchronoulsy run at command parser.
  * Commands handlers will be call from this function context.
@@ -376,6 +753,90 @@ void cat_init(struct cat_object *self, const struct cat_descriptor *desc, const
  */
 cat_status cat_service(struct cat_object *self);
 
+/**
+ * Function used to service the at command parser until it is idle or blocked.
+ * Mutex is locked only once, then both at command and unsolicited fsm are advanced
+ * until there is nothing to do, no progress is made (e.g. waiting for io or hold exit) or steps budget is used up.
+ * 
+ * @param self pointer to at command parser object
+ * @param max_steps maximum number of service steps
+ * @param steps pointer to number of consumed service steps (optional, can be NULL)
+ * @return status of last service step (like cat_service), OK if parser is idle
+ */
+cat_status cat_service_run(struct cat_object *self, size_t max_steps, size_t *steps);
+
+/**
+ * Function used to read reason of parser waiting after last service call (cat_service, cat_service_run or cat_service_timed),
+ * so host loop can sleep on right event (input readable, output writable, timer) instead of busy polling.
+ * Unsolicited events triggered from other threads need service too, so host should be also woken by triggering code.
+ * 
+ * @param self pointer to at command parser object
+ * @param hint pointer to wait hint to fill
+ * @return according to cat_status, OK if successfully read
+ */
+cat_status cat_get_wait_hint(struct cat_object *self, cat_wait_hint *hint);
+
+/**
+ * Function used to feed input ring buffer with received chars.
+ * It is lock-free single producer function (safe to call from isr or other thread than cat_service),
+ * but only one producer can feed input at a time. Mutex is not used.
+ * 
+ * @param self pointer to at command parser object
+ * @param buf pointer to received chars
+ * @param len number of received chars
+ * @return number of chars stored in input ring buffer (less than len if ring is full)
+ */
+size_t cat_feed_input(struct cat_object *self, const char *buf, size_t len);
+
+/**
+ * Function used to attach clock interface required by timed service.
+ * 
+ * @param self pointer to at command parser object
+ * @param clock pointer to clock interface (NULL to detach)
+ * @return according to cat_status, OK if successfully attached
+ */
+cat_status cat_set_clock_interface(struct cat_object *self, const struct cat_clock_interface *clock);
+
+/**
+ * Function used to service the at command parser within time budget.
+ * Works like cat_service_run, but steps are limited by elapsed time measured by clock interface.
+ * Budget is checked between service steps, so next call resumes from the step where previous one yielded.
+ * 
+ * @param self pointer to at command parser object
+ * @param budget_us time budget in microseconds
+ * @return status of last service step (like cat_service), OK if parser is idle
+ *         CAT_STATUS_ERROR - clock interface is not attached (parser is not serviced)
+ */
+cat_status cat_service_timed(struct cat_object *self, uint32_t budget_us);
+
+/**
+ * Function used to read and optionally clear timed service statistics.
+ * 
+ * @param self pointer to at command parser object
+ * @param stats pointer to statistics structure to fill
+ * @param clear flag to clear statistics after read
+ * @return according to cat_status, OK if successfully read
+ */
+cat_status cat_get_service_stats(struct cat_object *self, struct cat_service_stats *stats, bool clear);
+
+/**
+ * Function used to synchronously process single complete command line (fast path for framed transports).
+ * Line is parsed in place, so write arguments are not copied into working buffer
+ * (write handler data points into line and is not null terminated, data_size must be used).
+ * Response is flushed by io interface before return (write functions are polled while they accept data).
+ * Many commands separated by new line chars can be processed within single line.
+ * If parser stops making progress (e.g. io write does not accept data) function returns BUSY
+ * and processing is continued by cat_service, so line must stay valid until parser is idle.
+ * 
+ * @param self pointer to at command parser object
+ * @param line pointer to command line (trailing new line char is optional)
+ * @param len length of command line
+ * @return OK if line processed, HOLD if command enabled hold state,
+ *         BUSY if line processing is continued by cat_service,
+ *         CAT_STATUS_ERROR_BUFFER_FULL if parser was not idle (line is not taken)
+ */
+cat_status cat_process_line(struct cat_object *self, const char *line, size_t len);
+
 /**
  * Function return flag which indicating internal busy state.
  * It is used to determine whether external application modules can use shared input / output interfaces functions.
@@ -402,27 +863,111 @@ cat_status cat_is_hold(struct cat_object *self);
 
 /**
  * Function return flag which indicating state of internal buffer of unsolicited events.
+ * Only buffer of normal priority events (used by cat_trigger_unsolicited_event) is checked.
+ * Function is lock-free, so returned state can be changed concurrently by other producers.
  * 
  * @param self pointer to at command parser object
  * @return CAT_STATUS_OK - buffer is not full, unsolicited event can be buffered
  *         CAT_STATUS_ERROR_BUFFER_FULL - buffer is full, unsolicited event cannot be buffered
- *         CAT_STATUS_ERROR_MUTEX_LOCK - cannot lock mutex error
- *         CAT_STATUS_ERROR_MUTEX_UNLOCK - cannot unlock mutex error
  */
 cat_status cat_is_unsolicited_buffer_full(struct cat_object *self);
 
 /**
  * Function sends unsolicited event message.
- * Command message is buffered inside parser in 1-level deep buffer and processed in cat_service context.
+ * Command message is buffered inside parser (queue depth is configured by descriptor) and processed in cat_service context.
  * Only command pointer is buffered, so command struct should be static or global until be fully processed.
+ * Function is lock-free and can be called concurrently from many threads (mutex is not locked).
+ * With pending events bitmap configured, event identical to already pending one is merged into it
+ * without taking buffer cell (event is pending since it is triggered until it is taken for processing,
+ * event merged into concurrently triggered one which is rejected because of full buffer is dropped with it,
+ * so rejected event should be triggered again to deliver both).
  * 
  * @param self pointer to at command parser object
  * @param cmd pointer to command structure regarding which unsolicited event applies to
  * @param type type of operation (only CAT_CMD_TYPE_READ and CAT_CMD_TYPE_TEST are allowed)
- * @return according to cat_return_state enum definitions
+ * @return CAT_STATUS_OK - event buffered
+ *         CAT_STATUS_ERROR_BUFFER_FULL - buffer is full, event cannot be buffered
  */
 cat_status cat_trigger_unsolicited_event(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type);
 
+/**
+ * Function sends unsolicited event message with given priority.
+ * Buffered events of higher priority are always processed before events of lower priority.
+ * Priority without own buffer configured in descriptor shares buffer with normal priority.
+ * Event is coalesced only with pending event placed in the same priority buffer,
+ * so higher priority event is never delayed by merging into lower priority one.
+ * 
+ * @param self pointer to at command parser object
+ * @param cmd pointer to command structure regarding which unsolicited event applies to
+ * @param type type of operation (only CAT_CMD_TYPE_READ and CAT_CMD_TYPE_TEST are allowed)
+ * @param priority priority class of event
+ * @return CAT_STATUS_OK - event buffered
+ *         CAT_STATUS_ERROR_BUFFER_FULL - buffer is full, event cannot be buffered
+ */
+cat_status cat_trigger_unsolicited_event_priority(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type, cat_unsolicited_priority priority);
+
+/**
+ * Function sends unsolicited event with response snapshot.
+ * Response "<command name>=<args>" is formatted at trigger time into payload arena slot,
+ * so in cat_service context it is only flushed (variables and read handler are not used).
+ * Snapshot events are never coalesced and with pending events bitmap configured
+ * they are not reported by cat_is_unsolicited_event_buffered.
+ * Function is lock-free and can be called concurrently from many threads (mutex is not locked).
+ * 
+ * @param self pointer to at command parser object
+ * @param cmd pointer to command structure regarding which unsolicited event applies to
+ * @param args pointer to already formatted arguments string
+ * @param priority priority class of event
+ * @return CAT_STATUS_OK - event buffered
+ *         CAT_STATUS_ERROR_BUFFER_FULL - buffer is full, event cannot be buffered
+ *         CAT_STATUS_ERROR - response does not fit into payload slot
+ */
+cat_status cat_trigger_unsolicited_snapshot(struct cat_object *self, struct cat_command const *cmd, const char *args, cat_unsolicited_priority priority);
+
+/**
+ * Function sends unsolicited event with snapshot of command variables.
+ * Response "<command name>=<variables>" is formatted from command variables at trigger time
+ * (like read response, variables read handlers are called) into payload arena slot,
+ * so in cat_service context it is only flushed and later changes of variables do not affect it.
+ * Command read handler is not used. Snapshot events are never coalesced.
+ * Variables are shared with cat_service, so they are formatted with mutex locked
+ * (function cannot be called from command handlers), only buffering of formatted event is lock-free.
+ * 
+ * @param self pointer to at command parser object
+ * @param cmd pointer to command structure with readable variables
+ * @param priority priority class of event
+ * @return CAT_STATUS_OK - event buffered
+ *         CAT_STATUS_ERROR_BUFFER_FULL - buffer is full, event cannot be buffered
+ *         CAT_STATUS_ERROR - command has no readable variables, variable read handler failed
+ *         or response does not fit into payload slot (its buffer item is released by cat_service)
+ *         CAT_STATUS_ERROR_MUTEX_LOCK - cannot lock mutex
+ *         CAT_STATUS_ERROR_MUTEX_UNLOCK - cannot unlock mutex
+ */
+cat_status cat_trigger_unsolicited_var_snapshot(struct cat_object *self, struct cat_command const *cmd, cat_unsolicited_priority priority);
+
+/**
+ * Function used to read and optionally clear unsolicited events output statistics
+ * (responses deferred by rate limit and events dropped on full buffer).
+ * 
+ * @param self pointer to at command parser object
+ * @param stats pointer to statistics structure to fill
+ * @param clear flag to clear statistics after read
+ * @return according to cat_status, OK if successfully read
+ */
+cat_status cat_get_unsolicited_rate_stats(struct cat_object *self, struct cat_unsolicited_rate_stats *stats, bool clear);
+
+/**
+ * Function used to read and optionally clear unsolicited events queue statistics of given priority.
+ * Function is lock-free, so returned depth can be changed concurrently by producers and service.
+ * 
+ * @param self pointer to at command parser object
+ * @param priority priority class of queue
+ * @param stats pointer to statistics structure to fill
+ * @param clear flag to reset high water mark to actual depth after read
+ * @return according to cat_status, OK if successfully read
+ */
+cat_status cat_get_unsolicited_queue_stats(struct cat_object *self, cat_unsolicited_priority priority, struct cat_unsolicited_queue_stats *stats, bool clear);
+
 /**
  * Function sends unsolicited read event message.
  * Command message is buffered inside parser in 1-level deep buffer and processed in cat_service context.
@@ -454,6 +999,39 @@ cat_status cat_trigger_unsolicited_test(struct cat_object *self, struct cat_comm
  */
 cat_status cat_hold_exit(struct cat_object *self, cat_status status);
 
+/**
+ * Function returns pending token of command processed by write or run handler.
+ * Token identifies command in flight, so it has to be passed to worker together with job,
+ * when handler returns CAT_RETURN_STATE_ASYNC (token is valid only within handler call).
+ * Function can be called only from write or run handler (mutex is not locked).
+ * 
+ * @param self pointer to at command parser object
+ * @return pending token of currently processed command
+ */
+size_t cat_async_get_token(struct cat_object *self);
+
+/**
+ * Function posts completion of command which handler returned CAT_RETURN_STATE_ASYNC.
+ * Completions are drained in cat_service context when parser is idle (between commands),
+ * then response "<command name>=<data>" (only if data is given and status is OK) is written,
+ * followed by OK or ERROR acknowledge. Responses of commands in flight are written in order of requests
+ * (completion of newer command waits for completion of older one).
+ * Every pending token can be completed only once, duplicated or stale completion is rejected.
+ * If token is completed while its handler is still running and handler then returns other state
+ * than CAT_RETURN_STATE_ASYNC, only handler response is written and the completion is dropped.
+ * Function is lock-free and can be called concurrently from many threads (mutex is not locked),
+ * so host should be also woken by completing code (like after triggering unsolicited event).
+ * 
+ * @param self pointer to at command parser object
+ * @param token pending token of completed command (see cat_async_get_token)
+ * @param status command status 0 - OK, else ERROR
+ * @param data pointer to response data string (optional, can be NULL)
+ * @return CAT_STATUS_OK - completion posted
+ *         CAT_STATUS_ERROR_NOT_PENDING - token is not pending (already completed or unknown)
+ *         CAT_STATUS_ERROR - response does not fit into payload slot (or arena is not configured), token is still pending
+ */
+cat_status cat_async_complete(struct cat_object *self, size_t token, cat_status status, const char *data);
+
 /**
  * Function used to searching registered command by its name.
  * 
@@ -506,6 +1084,36 @@ struct cat_command const* cat_get_processed_command(struct cat_object *self, cat
  */
 cat_status cat_is_unsolicited_event_buffered(struct cat_object *self, struct cat_command const *cmd, cat_cmd_type type);
 
+/**
+ * Function used to refresh disabled commands bitmap (if configured in descriptor).
+ * It must be called after changing disable flag of any command or commands group.
+ * 
+ * @param self pointer to at command parser object
+ * @return according to cat_return_state enum definitions
+ */
+cat_status cat_update_disable_state(struct cat_object *self);
+
+/**
+ * Function used to update case-insensitive command name hash with next name char.
+ * Hash of whole name is computed by starting from CAT_HASH_INIT value.
+ * It is used by cat-gen tool to build commands hash table and by parser to search commands.
+ * 
+ * @param hash current hash value
+ * @param ch next command name char
+ * @return updated hash value
+ */
+uint32_t cat_hash_update(uint32_t hash, char ch);
+
+/**
+ * Function used to compute commands hash table slot mixing value.
+ * Slot of command name is computed as cat_hash_mix(hash, seed[hash % seed_num]) % num.
+ * 
+ * @param hash command name hash
+ * @param seed bucket displacement seed
+ * @return mixed hash value
+ */
+uint32_t cat_hash_mix(uint32_t hash, uint32_t seed);
+
 #ifdef __cplusplus
 }
 #endif
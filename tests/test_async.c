@@ -0,0 +1,290 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char ack_results[256];
+static const char *input_text;
+static uint32_t set_value;
+static uint32_t set_job;
+
+static struct cat_object at;
+static size_t tokens[4];
+static size_t tokens_num;
+
+static cat_return_state slow_run(const struct cat_command *cmd)
+{
+        tokens[tokens_num++] = cat_async_get_token(&at);
+        return CAT_RETURN_STATE_ASYNC;
+}
+
+static cat_return_state sync_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state set_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        /* parsed variable is copied, because next command can overwrite it before completion */
+        set_job = set_value;
+        tokens[tokens_num++] = cat_async_get_token(&at);
+        return CAT_RETURN_STATE_ASYNC;
+}
+
+/* worker completes token before handler returns, then handler answers synchronously */
+static cat_return_state race_run(const struct cat_command *cmd)
+{
+        assert(cat_async_complete(&at, cat_async_get_token(&at), CAT_STATUS_OK, "late") == CAT_STATUS_OK);
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state race_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        tokens[tokens_num++] = cat_async_get_token(&at);
+        assert(cat_async_complete(&at, tokens[tokens_num - 1], CAT_STATUS_ERROR, NULL) == CAT_STATUS_OK);
+        return CAT_RETURN_STATE_ERROR;
+}
+
+static cat_return_state rd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        return CAT_RETURN_STATE_ASYNC;
+}
+
+static struct cat_variable set_vars[] = {
+        {
+                .type = CAT_VAR_UINT_DEC,
+                .data = &set_value,
+                .data_size = sizeof(set_value)
+        }
+};
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+SLOW",
+                .run = slow_run
+        },
+        {
+                .name = "+SYNC",
+                .run = sync_run
+        },
+        {
+                .name = "+SET",
+                .write = set_write,
+                .var = set_vars,
+                .var_num = sizeof(set_vars) / sizeof(set_vars[0])
+        },
+        {
+                .name = "+RD",
+                .read = rd_read
+        },
+        {
+                .name = "+RACE",
+                .run = race_run,
+                .write = race_write
+        }
+};
+
+static char buf[128];
+static struct cat_async_completion async_buf[2];
+static char async_arena_buf[2 * 16];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .async_buf = async_buf,
+        .async_buf_num = sizeof(async_buf) / sizeof(async_buf[0]),
+        .async_arena_buf = async_arena_buf,
+        .async_arena_buf_size = sizeof(async_arena_buf),
+        .async_arena_slot_size = sizeof(async_arena_buf) / (sizeof(async_buf) / sizeof(async_buf[0]))
+};
+
+static struct cat_descriptor desc_sync = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf)
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if ((input_text == NULL) || (*input_text == 0))
+                return 0;
+
+        *ch = *input_text++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static cat_wait_hint service(struct cat_object *self)
+{
+        cat_wait_hint hint;
+
+        cat_service_run(self, 1000, NULL);
+        assert(cat_get_wait_hint(self, &hint) == CAT_STATUS_OK);
+        return hint;
+}
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        memset(ack_results, 0, sizeof(ack_results));
+        tokens_num = 0;
+}
+
+int main(int argc, char **argv)
+{
+        /* without completions buffer asynchronous command ends with error */
+        cat_init(&at, &desc_sync, &iface, NULL);
+
+        prepare_input("AT+SLOW\r\n");
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\r\nERROR\r\n") == 0);
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        /* input is still parsed while command is in flight */
+        prepare_input("AT+SLOW\r\nAT+SYNC\r\n");
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\r\nOK\r\n") == 0);
+        assert(cat_service(&at) == CAT_STATUS_BUSY);
+        assert(cat_is_busy(&at) == CAT_STATUS_OK);
+        assert(tokens_num == 1);
+
+        prepare_input("");
+        assert(cat_async_complete(&at, 0, CAT_STATUS_OK, "7") == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\r\n+SLOW=7\r\n\r\nOK\r\n") == 0);
+        assert(cat_service(&at) == CAT_STATUS_OK);
+
+        /* completed token is not pending anymore */
+        assert(cat_async_complete(&at, 0, CAT_STATUS_OK, NULL) == CAT_STATUS_ERROR_NOT_PENDING);
+        assert(cat_async_complete(&at, 1, CAT_STATUS_OK, NULL) == CAT_STATUS_ERROR_NOT_PENDING);
+        assert(cat_service(&at) == CAT_STATUS_OK);
+
+        /* next command waits for free completion cell */
+        prepare_input("AT+SLOW\nAT+SET=5\nAT+SYNC\n");
+        assert(service(&at) == CAT_WAIT_HINT_ASYNC);
+        assert(strcmp(ack_results, "") == 0);
+        assert(set_job == 5);
+        assert(tokens_num == 2);
+
+        /* newer command response waits for older one */
+        assert(cat_async_complete(&at, tokens[1], CAT_STATUS_OK, "5") == CAT_STATUS_OK);
+        assert(cat_async_complete(&at, tokens[1], CAT_STATUS_OK, NULL) == CAT_STATUS_ERROR_NOT_PENDING);
+        assert(service(&at) == CAT_WAIT_HINT_ASYNC);
+        assert(strcmp(ack_results, "") == 0);
+
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_ERROR, "ignored") == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\nERROR\n\n+SET=5\n\nOK\n\nOK\n") == 0);
+        assert(cat_service(&at) == CAT_STATUS_OK);
+
+        /* every response uses new line chars of its own request */
+        prepare_input("AT+SLOW\r\nAT+SLOW\n");
+        assert(service(&at) == CAT_WAIT_HINT_ASYNC);
+        assert(cat_async_complete(&at, tokens[1], CAT_STATUS_OK, "b") == CAT_STATUS_OK);
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_OK, "a") == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\r\n+SLOW=a\r\n\r\nOK\r\n\n+SLOW=b\n\nOK\n") == 0);
+
+        /* response must fit into payload slot */
+        prepare_input("AT+SLOW\n");
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_OK, "0123456789") == CAT_STATUS_ERROR);
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_OK, NULL) == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\nOK\n") == 0);
+
+        /* only write and run handlers can go asynchronous */
+        prepare_input("AT+RD?\n");
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\nERROR\n") == 0);
+        assert(cat_service(&at) == CAT_STATUS_OK);
+
+        /* token of synchronous command is released after handler call */
+        prepare_input("AT+SYNC\n");
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(cat_async_complete(&at, cat_async_get_token(&at), CAT_STATUS_OK, NULL) == CAT_STATUS_ERROR_NOT_PENDING);
+
+        /* completion claimed while handler is running is dropped, handler response is the only one */
+        prepare_input("AT+RACE\nAT+RACE=1\nAT+SYNC\n");
+        while (cat_service(&at) != CAT_STATUS_OK) {};
+        assert(strcmp(ack_results, "\nOK\n\nERROR\n\nOK\n") == 0);
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_OK, NULL) == CAT_STATUS_ERROR_NOT_PENDING);
+
+        /* both cells are free again */
+        prepare_input("AT+SLOW\nAT+SLOW\n");
+        assert(service(&at) == CAT_WAIT_HINT_ASYNC);
+        assert(tokens_num == 2);
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_OK, NULL) == CAT_STATUS_OK);
+        assert(cat_async_complete(&at, tokens[1], CAT_STATUS_OK, NULL) == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\nOK\n\nOK\n") == 0);
+
+        /* completion is written also by processed line */
+        prepare_input("");
+        assert(cat_process_line(&at, "AT+SLOW\r\n", 9) == CAT_STATUS_OK);
+        assert(strcmp(ack_results, "") == 0);
+        assert(cat_async_complete(&at, tokens[0], CAT_STATUS_OK, "1") == CAT_STATUS_OK);
+        assert(cat_process_line(&at, "AT+SYNC\n", 8) == CAT_STATUS_OK);
+        assert(strcmp(ack_results, "\r\n+SLOW=1\r\n\r\nOK\r\n\nOK\n") == 0);
+        assert(cat_service(&at) == CAT_STATUS_OK);
+
+        return 0;
+}
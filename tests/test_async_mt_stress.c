@@ -0,0 +1,301 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define WORKERS_NUM (4U)
+#define JOBS_NUM (2000U)
+#define IN_FLIGHT_MAX (256U)
+#define PING_PERIOD (8U)
+
+static struct cat_object at;
+static pthread_t consumer;
+
+static char input_text[JOBS_NUM * 24];
+static size_t input_pos;
+
+static char line[64];
+static size_t line_len;
+static long last_job;
+static long prev_job = -1;
+static size_t job_done_cntr;
+static size_t error_cntr;
+static size_t ok_cntr;
+static bool job_done[JOBS_NUM];
+
+static uint32_t job_value;
+static atomic_size_t in_flight;
+static size_t in_flight_max;
+static size_t ping_in_flight_max;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t pool_jobs[IN_FLIGHT_MAX];
+static size_t pool_tokens[IN_FLIGHT_MAX];
+static size_t pool_head;
+static size_t pool_tail;
+static bool pool_stop;
+
+static cat_return_state job_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num);
+static cat_return_state ping_run(const struct cat_command *cmd);
+
+static struct cat_variable job_vars[] = {
+        {
+                .type = CAT_VAR_UINT_DEC,
+                .data = &job_value,
+                .data_size = sizeof(job_value)
+        }
+};
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+JOB",
+                .write = job_write,
+                .var = job_vars,
+                .var_num = sizeof(job_vars) / sizeof(job_vars[0])
+        },
+        {
+                .name = "+PING",
+                .run = ping_run
+        }
+};
+
+static cat_return_state job_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        size_t n;
+
+        assert(pthread_equal(pthread_self(), consumer) != 0);
+
+        /* parser never starts more commands than completions buffer can hold */
+        n = atomic_fetch_add(&in_flight, 1) + 1;
+        assert(n <= IN_FLIGHT_MAX);
+        if (n > in_flight_max)
+                in_flight_max = n;
+
+        pthread_mutex_lock(&pool_mutex);
+        pool_tokens[pool_tail % IN_FLIGHT_MAX] = cat_async_get_token(&at);
+        pool_jobs[pool_tail++ % IN_FLIGHT_MAX] = job_value;
+        pthread_cond_signal(&pool_cond);
+        pthread_mutex_unlock(&pool_mutex);
+
+        return CAT_RETURN_STATE_ASYNC;
+}
+
+static cat_return_state ping_run(const struct cat_command *cmd)
+{
+        size_t n = atomic_load(&in_flight);
+
+        if (n > ping_in_flight_max)
+                ping_in_flight_max = n;
+
+        return CAT_RETURN_STATE_OK;
+}
+
+static char buf[128];
+static struct cat_async_completion async_buf[IN_FLIGHT_MAX];
+static char async_arena_buf[IN_FLIGHT_MAX * 16];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .async_buf = async_buf,
+        .async_buf_num = sizeof(async_buf) / sizeof(async_buf[0]),
+        .async_arena_buf = async_arena_buf,
+        .async_arena_buf_size = sizeof(async_arena_buf),
+        .async_arena_slot_size = sizeof(async_arena_buf) / (sizeof(async_buf) / sizeof(async_buf[0]))
+};
+
+static void parse_line(void)
+{
+        long job;
+
+        line[line_len] = 0;
+        line_len = 0;
+
+        if (line[0] == 0)
+                return;
+
+        if (strncmp(line, "+JOB=", 5) == 0) {
+                job = strtol(&line[5], NULL, 10);
+                assert((job >= 0) && (job < (long)JOBS_NUM));
+                assert(job_done[job] == false);
+                assert(last_job < 0);
+                /* responses are written in order of requests */
+                assert(job > prev_job);
+                prev_job = job;
+                job_done[job] = true;
+                last_job = job;
+        } else if (strcmp(line, "OK") == 0) {
+                ok_cntr++;
+                if (last_job >= 0)
+                        job_done_cntr++;
+                last_job = -1;
+        } else if (strcmp(line, "ERROR") == 0) {
+                /* failed jobs are acknowledged without response data */
+                assert(last_job < 0);
+                error_cntr++;
+        } else {
+                assert(false);
+        }
+}
+
+static int write_char(char ch)
+{
+        if (ch == '\n') {
+                parse_line();
+        } else if (ch != '\r') {
+                assert(line_len < sizeof(line) - 1);
+                line[line_len++] = ch;
+        }
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_text[input_pos] == 0)
+                return 0;
+
+        *ch = input_text[input_pos++];
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void* worker_thread(void *arg)
+{
+        uint32_t job;
+        size_t token;
+        char data[16];
+        cat_status s;
+
+        while (true) {
+                pthread_mutex_lock(&pool_mutex);
+                while ((pool_head == pool_tail) && (pool_stop == false))
+                        pthread_cond_wait(&pool_cond, &pool_mutex);
+                if (pool_head == pool_tail) {
+                        pthread_mutex_unlock(&pool_mutex);
+                        break;
+                }
+                token = pool_tokens[pool_head % IN_FLIGHT_MAX];
+                job = pool_jobs[pool_head++ % IN_FLIGHT_MAX];
+                pthread_mutex_unlock(&pool_mutex);
+
+                /* uneven work duration, so jobs are completed out of order */
+                usleep(20 + (job * 7919U) % 200U);
+
+                atomic_fetch_sub(&in_flight, 1);
+                snprintf(data, sizeof(data), "%u", (unsigned)job);
+                s = cat_async_complete(&at, token, ((job % 10) == 0) ? CAT_STATUS_ERROR : CAT_STATUS_OK, data);
+                assert(s == CAT_STATUS_OK);
+                /* duplicated completion is rejected and does not disturb parser */
+                assert(cat_async_complete(&at, token, CAT_STATUS_OK, NULL) == CAT_STATUS_ERROR_NOT_PENDING);
+        }
+
+        return NULL;
+}
+
+int main(int argc, char **argv)
+{
+        pthread_t workers[WORKERS_NUM];
+        cat_wait_hint hint;
+        size_t i;
+        size_t len = 0;
+        size_t ping_num = 0;
+
+        consumer = pthread_self();
+        last_job = -1;
+
+        for (i = 0; i < JOBS_NUM; i++) {
+                len += sprintf(&input_text[len], "AT+JOB=%u\r\n", (unsigned)i);
+                if ((i % PING_PERIOD) == 0) {
+                        len += sprintf(&input_text[len], "AT+PING\r\n");
+                        ping_num++;
+                }
+        }
+        assert(len < sizeof(input_text));
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        for (i = 0; i < WORKERS_NUM; i++)
+                assert(pthread_create(&workers[i], NULL, worker_thread, NULL) == 0);
+
+        while (ok_cntr + error_cntr < JOBS_NUM + ping_num) {
+                cat_service(&at);
+                assert(cat_get_wait_hint(&at, &hint) == CAT_STATUS_OK);
+                /* give workers a chance to run on single core hosts */
+                if (hint != CAT_WAIT_HINT_NONE)
+                        sched_yield();
+        }
+
+        pthread_mutex_lock(&pool_mutex);
+        pool_stop = true;
+        pthread_cond_broadcast(&pool_cond);
+        pthread_mutex_unlock(&pool_mutex);
+
+        for (i = 0; i < WORKERS_NUM; i++)
+                assert(pthread_join(workers[i], NULL) == 0);
+
+        while (cat_service(&at) != CAT_STATUS_OK) {};
+        assert(input_text[input_pos] == 0);
+
+        assert(error_cntr == JOBS_NUM / 10);
+        assert(job_done_cntr == JOBS_NUM - JOBS_NUM / 10);
+        assert(ok_cntr == job_done_cntr + ping_num);
+        for (i = 0; i < JOBS_NUM; i++)
+                assert(job_done[i] == ((i % 10) != 0));
+
+        /* hundreds of commands were in flight and input path was still serviced meanwhile */
+        assert(in_flight_max > IN_FLIGHT_MAX / 2);
+        assert(ping_in_flight_max > 0);
+
+        return 0;
+}
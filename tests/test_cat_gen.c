@@ -0,0 +1,163 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#include "test_cat_gen.h"
+#include "test_cat_gen_cmds.h"
+
+int8_t var_x;
+char var_msg[16];
+uint16_t var_info;
+
+static char run_results[256];
+static char ack_results[256];
+
+static char const *input_text;
+static size_t input_index;
+
+cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        strcat(run_results, " R_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_OK;
+}
+
+cat_return_state cmd_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        strcat(run_results, " W_");
+        strcat(run_results, cmd->name);
+        strcat(run_results, ":");
+        strncat(run_results, (const char *)data, data_size);
+        return CAT_RETURN_STATE_OK;
+}
+
+cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        strcat(run_results, " D_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+int var_write(const struct cat_variable *var, const size_t write_size)
+{
+        strcat(run_results, " V_");
+        strcat(run_results, var->name);
+        return 0;
+}
+
+static char buf[256];
+static struct cat_command_index cmd_index[TEST_GEN_CMD_NUM];
+
+static struct cat_descriptor desc = {
+        .cmd_group = test_gen_cmd_group,
+        .cmd_group_num = TEST_GEN_CMD_GROUP_NUM,
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .cmd_index = cmd_index,
+        .cmd_index_num = sizeof(cmd_index) / sizeof(cmd_index[0]),
+
+        .cmd_hash = &test_gen_cmd_hash
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+
+        var_x = 0;
+        var_info = 7;
+        memset(var_msg, 0, sizeof(var_msg));
+
+        memset(run_results, 0, sizeof(run_results));
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char test_case_1[] = "\nAT+TEST\nAT+TEST_\nAT+TEST_A=1\nAT+SET=?\nAT+SET=-5,\"msg\"\nAT+SET?\nAT+INFO?\nAT+IN?\nAT+OFF\nAT+HIDDEN\nATD1\n";
+
+static void check_results(void)
+{
+        assert(strcmp(ack_results, "\nOK\n\nERROR\n\nOK\n\n+set=<X:INT8[RW]>,<MSG:STRING[RW]>\nSet \"X\" and message.\n\nOK\n\nOK\n\n+set=-5,\"msg\"\n\nOK\n\n+INFO=7\n\nOK\n\n+INFO=7\n\nOK\n\nERROR\n\nERROR\n\nOK\n") == 0);
+        assert(strcmp(run_results, " R_+TEST W_+TEST_A:1 V_MSG D_+INFO D_+INFO W_D:1") == 0);
+        assert(var_x == -5);
+        assert(strcmp(var_msg, "msg") == 0);
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        struct cat_command_group const *cmd_group;
+        size_t i, j;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        prepare_input(test_case_1);
+        while (cat_service(&at) != 0) {};
+        check_results();
+
+        for (i = 0; i < TEST_GEN_CMD_GROUP_NUM; i++) {
+                cmd_group = test_gen_cmd_group[i];
+                for (j = 0; j < cmd_group->cmd_num; j++)
+                        assert(cat_search_command_by_name(&at, cmd_group->cmd[j].name) == &cmd_group->cmd[j]);
+        }
+        assert(cat_search_command_by_name(&at, "+SET") == NULL);
+        assert(cat_search_command_by_name(&at, "+TEST_C") == NULL);
+        assert(cat_search_command_by_name(&at, "") == NULL);
+
+        return 0;
+}
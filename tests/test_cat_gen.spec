@@ -0,0 +1,39 @@
+# commands table used by test_cat_gen (compiled by cat-gen tool)
+
+prefix test_gen
+include "test_cat_gen.h"
+
+group basic
+
+command +TEST
+run cmd_run
+
+command +TEST_A
+run cmd_run
+write cmd_write
+
+command +TEST_B
+run cmd_run
+
+command +set
+description "Set \"X\" and message."
+var X int var_x
+var MSG string var_msg rw write=var_write
+need_all_vars
+
+command +INFO
+read cmd_read
+var - uint var_info ro
+
+command +off
+run cmd_run
+disable
+
+command D
+write cmd_write
+implicit_write
+
+group hidden disable
+
+command +HIDDEN
+run cmd_run
@@ -0,0 +1,226 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char run_results[512];
+static char ack_results[512];
+
+static char const *input_text;
+static size_t input_index;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        strcat(run_results, " R_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state cmd_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        strcat(run_results, " W_");
+        strcat(run_results, cmd->name);
+        strcat(run_results, ":");
+        strncat(run_results, (const char *)data, data_size);
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+TEST",
+                .run = cmd_run
+        },
+        {
+                .name = "+TEST_B",
+                .run = cmd_run,
+                .write = cmd_write
+        },
+        {
+                .name = "+TEST_A",
+                .run = cmd_run,
+                .write = cmd_write
+        },
+        {
+                .name = "+two",
+                .run = cmd_run
+        },
+        {
+                .name = "+ONE",
+                .run = cmd_run
+        },
+        {
+                .name = "+OFF",
+                .run = cmd_run,
+                .disable = true
+        },
+        {
+                .name = "+TWO",
+                .run = cmd_run
+        },
+        {
+                .name = "D",
+                .write = cmd_write,
+                .implicit_write = true
+        },
+        {
+                .name = "DX",
+                .run = cmd_run
+        },
+        {
+                .name = "+TEST_C",
+                .run = cmd_run,
+                .write = cmd_write
+        },
+};
+
+static struct cat_command disabled_cmds[] = {
+        {
+                .name = "+GROUP",
+                .run = cmd_run
+        },
+        {
+                .name = "+ON",
+                .run = cmd_run
+        },
+};
+
+static char buf[256];
+static char index_buf[256];
+static struct cat_command_index cmd_index[12];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group disabled_cmd_group = {
+        .cmd = disabled_cmds,
+        .cmd_num = sizeof(disabled_cmds) / sizeof(disabled_cmds[0]),
+        .disable = true
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &disabled_cmd_group,
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf)
+};
+
+static struct cat_descriptor index_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = index_buf,
+        .buf_size = sizeof(index_buf),
+
+        .cmd_index = cmd_index,
+        .cmd_index_num = sizeof(cmd_index) / sizeof(cmd_index[0])
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+
+        memset(run_results, 0, sizeof(run_results));
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char test_case_1[] = "\nAT+\nAT+T\nAT+TEST\nAT+TEST_\nAT+TEST_=1\nAT+TEST_A\nat+test_b=2\nAT+TE\nAT+TW\nAT+TWO\nAT+O\nAT+ON\nAT+OF\nAT+OFF\nAT+G\nATD\nATDX\nATD?\nAT+X\nAT+X=1\n";
+
+static void run_test_case(struct cat_object *self, const char *text, char *run_out, char *ack_out)
+{
+        prepare_input(text);
+        while (cat_service(self) != 0) {};
+
+        strcpy(run_out, run_results);
+        strcpy(ack_out, ack_results);
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        struct cat_object at_index;
+        static char scan_run[512], scan_ack[512];
+        static char index_run[512], index_ack[512];
+
+        cat_init(&at, &desc, &iface, NULL);
+        cat_init(&at_index, &index_desc, &iface, NULL);
+
+        run_test_case(&at, test_case_1, scan_run, scan_ack);
+        run_test_case(&at_index, test_case_1, index_run, index_ack);
+
+        assert(strcmp(index_ack, scan_ack) == 0);
+        assert(strcmp(index_run, scan_run) == 0);
+
+        assert(strcmp(index_ack, "\nERROR\n\nERROR\n\nOK\n\nERROR\n\nERROR\n\nOK\n\nOK\n\nERROR\n\nERROR\n\nOK\n\nOK\n\nOK\n\nERROR\n\nERROR\n\nERROR\n\nOK\n\nOK\n\nOK\n\nERROR\n\nERROR\n") == 0);
+        assert(strcmp(index_run, " R_+TEST R_+TEST_A W_+TEST_B:2 R_+two R_+ONE R_+ONE W_D: W_D:X W_D:?") == 0);
+
+        assert(cat_search_command_by_name(&at_index, "+TEST_A") == &cmds[2]);
+        assert(cat_search_command_by_name(&at_index, "+TWO") == &cmds[6]);
+        assert(cat_search_command_by_name(&at_index, "+two") == &cmds[3]);
+        assert(cat_search_command_by_name(&at_index, "+Two") == NULL);
+        assert(cat_search_command_by_name(&at_index, "+GROUP") == &disabled_cmds[0]);
+        assert(cat_search_command_by_name(&at_index, "+TEST_") == NULL);
+        assert(cat_search_command_by_name(&at_index, "") == NULL);
+
+        return 0;
+}
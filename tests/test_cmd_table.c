@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char run_results[256];
+static char ack_results[256];
+
+static char const *input_text;
+static size_t input_index;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        strcat(run_results, " R_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds1[] = {
+        {
+                .name = "+A1",
+                .run = cmd_run
+        },
+        {
+                .name = "+A2",
+                .run = cmd_run
+        },
+};
+
+static struct cat_command cmds2[] = {
+        {
+                .name = "+B1",
+                .run = cmd_run
+        },
+};
+
+static struct cat_command cmds3[] = {
+        {
+                .name = "+C1",
+                .run = cmd_run
+        },
+        {
+                .name = "+C2",
+                .run = cmd_run
+        },
+        {
+                .name = "+C3",
+                .run = cmd_run
+        },
+};
+
+static char buf[128];
+static struct cat_command const *cmd_table[6];
+static uint8_t cmd_disable_buf[1];
+
+static struct cat_command_group cmd_group1 = {
+        .name = "A",
+        .cmd = cmds1,
+        .cmd_num = sizeof(cmds1) / sizeof(cmds1[0]),
+};
+
+static struct cat_command_group cmd_group2 = {
+        .name = "B",
+        .cmd = cmds2,
+        .cmd_num = sizeof(cmds2) / sizeof(cmds2[0]),
+};
+
+static struct cat_command_group cmd_group3 = {
+        .name = "C",
+        .cmd = cmds3,
+        .cmd_num = sizeof(cmds3) / sizeof(cmds3[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group1,
+        &cmd_group2,
+        &cmd_group3
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .cmd_table = cmd_table,
+        .cmd_table_num = sizeof(cmd_table) / sizeof(cmd_table[0]),
+
+        .cmd_disable_buf = cmd_disable_buf,
+        .cmd_disable_buf_size = sizeof(cmd_disable_buf)
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+
+        memset(run_results, 0, sizeof(run_results));
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char test_case_1[] = "\nAT+A1\nAT+A2\nAT+B\nAT+C1\nAT+C2\nAT+C3\n";
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        assert(cmd_table[0] == &cmds1[0]);
+        assert(cmd_table[2] == &cmds2[0]);
+        assert(cmd_table[5] == &cmds3[2]);
+        assert(cmd_disable_buf[0] == 0x00);
+
+        prepare_input(test_case_1);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\nOK\n\nOK\n\nOK\n\nOK\n\nOK\n\nOK\n") == 0);
+        assert(strcmp(run_results, " R_+A1 R_+A2 R_+B1 R_+C1 R_+C2 R_+C3") == 0);
+
+        cmd_group1.disable = true;
+        cmds3[1].disable = true;
+
+        /* flags are not visible until bitmap is refreshed */
+        prepare_input(test_case_1);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\nOK\n\nOK\n\nOK\n\nOK\n\nOK\n\nOK\n") == 0);
+        assert(strcmp(run_results, " R_+A1 R_+A2 R_+B1 R_+C1 R_+C2 R_+C3") == 0);
+
+        assert(cat_update_disable_state(&at) == CAT_STATUS_OK);
+        assert(cmd_disable_buf[0] == 0x13);
+
+        prepare_input(test_case_1);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\nERROR\n\nERROR\n\nOK\n\nOK\n\nERROR\n\nOK\n") == 0);
+        assert(strcmp(run_results, " R_+B1 R_+C1 R_+C3") == 0);
+
+        cmd_group1.disable = false;
+        cmds3[1].disable = false;
+
+        assert(cat_update_disable_state(&at) == CAT_STATUS_OK);
+        assert(cmd_disable_buf[0] == 0x00);
+
+        assert(cat_search_command_by_name(&at, "+C2") == &cmds3[1]);
+
+        return 0;
+}
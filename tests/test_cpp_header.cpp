@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <cstdio>
+#include <cstring>
+
+#include <cassert>
+
+#include "../src/cat.h"
+
+/* sizes of public structures seen by library (compiled as C) */
+extern "C" size_t test_cpp_header_c_object_size(void);
+extern "C" size_t test_cpp_header_c_queue_size(void);
+extern "C" size_t test_cpp_header_c_unsolicited_fsm_size(void);
+extern "C" size_t test_cpp_header_c_unsolicited_cmd_size(void);
+extern "C" size_t test_cpp_header_c_async_completion_size(void);
+
+static_assert(sizeof(atomic_size_t) == sizeof(size_t), "atomic_size_t layout differs from C");
+static_assert(sizeof(atomic_uchar) == sizeof(unsigned char), "atomic_uchar layout differs from C");
+
+static char ack_results[256];
+static const char *input_text;
+static size_t input_index;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_OK;
+}
+
+static int write_char(char ch)
+{
+        size_t len = strlen(ack_results);
+
+        assert(len < sizeof(ack_results) - 1);
+        ack_results[len] = ch;
+        ack_results[len + 1] = 0;
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_text[input_index] == 0)
+                return 0;
+
+        *ch = input_text[input_index++];
+        return 1;
+}
+
+int main(int argc, char **argv)
+{
+        static struct cat_command cmds[1];
+        static struct cat_command_group cmd_group;
+        static struct cat_command_group *cmd_desc[1];
+        static struct cat_descriptor desc;
+        static struct cat_io_interface iface;
+        static struct cat_unsolicited_fsm unsolicited_fsm;
+        static struct cat_unsolicited_cmd unsolicited_cmd_buf[2];
+        static struct cat_command_index cmd_addr_index[2];
+        static atomic_uchar unsolicited_pending_buf[CAT_UNSOLICITED_PENDING_BUF_SIZE(1)];
+        static uint8_t buf[64];
+        struct cat_object at;
+
+        /* c++ consumer sees the same layout of structures with atomic fields as library */
+        assert(sizeof(struct cat_object) == test_cpp_header_c_object_size());
+        assert(sizeof(struct cat_unsolicited_fsm) == test_cpp_header_c_unsolicited_fsm_size());
+        assert(sizeof(struct cat_unsolicited_queue) == test_cpp_header_c_queue_size());
+        assert(sizeof(struct cat_unsolicited_cmd) == test_cpp_header_c_unsolicited_cmd_size());
+        assert(sizeof(struct cat_async_completion) == test_cpp_header_c_async_completion_size());
+
+        cmds[0].name = "+RUN";
+        cmds[0].run = cmd_run;
+        cmd_group.cmd = cmds;
+        cmd_group.cmd_num = 1;
+        cmd_desc[0] = &cmd_group;
+
+        desc.cmd_group = cmd_desc;
+        desc.cmd_group_num = 1;
+        desc.buf = buf;
+        desc.buf_size = sizeof(buf);
+        desc.unsolicited_fsm = &unsolicited_fsm;
+        desc.unsolicited_cmd_buf = unsolicited_cmd_buf;
+        desc.unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]);
+        desc.cmd_addr_index = cmd_addr_index;
+        desc.cmd_addr_index_num = sizeof(cmd_addr_index) / sizeof(cmd_addr_index[0]);
+        desc.unsolicited_pending_buf = unsolicited_pending_buf;
+        desc.unsolicited_pending_buf_size = sizeof(unsolicited_pending_buf);
+
+        iface.read = read_char;
+        iface.write = write_char;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        input_text = "AT+RUN\n";
+        input_index = 0;
+        while (cat_service(&at) != 0) {};
+        assert(strcmp(ack_results, "\nOK\n") == 0);
+
+        /* atomic state of object is shared with library code */
+        assert(cat_trigger_unsolicited_test(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_test(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_event_buffered(&at, &cmds[0], CAT_CMD_TYPE_TEST) == CAT_STATUS_BUSY);
+        assert(atomic_load(&unsolicited_pending_buf[0]) != 0);
+
+        ack_results[0] = 0;
+        while (cat_service(&at) != 0) {};
+        assert(strcmp(ack_results, "\n+RUN=\n") == 0);
+        assert(atomic_load(&unsolicited_pending_buf[0]) == 0);
+
+        return 0;
+}
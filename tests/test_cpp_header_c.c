@@ -0,0 +1,54 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "../src/cat.h"
+
+/* sizes of public structures seen by C compiler (checked by test_cpp_header) */
+
+size_t test_cpp_header_c_object_size(void)
+{
+        return sizeof(struct cat_object);
+}
+
+size_t test_cpp_header_c_queue_size(void)
+{
+        return sizeof(struct cat_unsolicited_queue);
+}
+
+size_t test_cpp_header_c_unsolicited_fsm_size(void)
+{
+        return sizeof(struct cat_unsolicited_fsm);
+}
+
+size_t test_cpp_header_c_unsolicited_cmd_size(void)
+{
+        return sizeof(struct cat_unsolicited_cmd);
+}
+
+size_t test_cpp_header_c_async_completion_size(void)
+{
+        return sizeof(struct cat_async_completion);
+}
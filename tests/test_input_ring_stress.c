@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define LINES_NUM (20000U)
+
+static struct cat_object at;
+
+static size_t write_cntr;
+static size_t ack_ok_cntr;
+static char ack_line[16];
+static size_t ack_line_len;
+
+static cat_return_state cmd_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        char tmp[16];
+
+        assert(data_size < sizeof(tmp));
+        memcpy(tmp, data, data_size);
+        tmp[data_size] = 0;
+
+        /* lines must be received in order and without loss */
+        assert((size_t)atoi(tmp) == write_cntr);
+        write_cntr++;
+
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+SET",
+                .write = cmd_write
+        },
+};
+
+static char buf[128];
+static char input_ring_buf[64];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .input_ring_buf = input_ring_buf,
+        .input_ring_size = sizeof(input_ring_buf)
+};
+
+static int write_char(char ch)
+{
+        if (ch == '\r')
+                return 1;
+
+        if (ch != '\n') {
+                assert(ack_line_len < sizeof(ack_line) - 1);
+                ack_line[ack_line_len++] = ch;
+                return 1;
+        }
+
+        ack_line[ack_line_len] = 0;
+        if (ack_line_len > 0) {
+                assert(strcmp(ack_line, "OK") == 0);
+                ack_ok_cntr++;
+        }
+        ack_line_len = 0;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .write = write_char
+};
+
+static void* producer_thread(void *arg)
+{
+        char line[32];
+        size_t i;
+        size_t len;
+        size_t pos;
+        size_t chunk;
+        unsigned seed = 1;
+
+        (void)arg;
+
+        for (i = 0; i < LINES_NUM; i++) {
+                len = sprintf(line, "AT+SET=%u\r\n", (unsigned)i);
+                pos = 0;
+                while (pos < len) {
+                        chunk = 1 + (rand_r(&seed) % 7);
+                        if (chunk > len - pos)
+                                chunk = len - pos;
+                        pos += cat_feed_input(&at, &line[pos], chunk);
+                        if (pos < len)
+                                sched_yield();
+                }
+        }
+
+        return NULL;
+}
+
+int main(int argc, char **argv)
+{
+        pthread_t producer;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        assert(pthread_create(&producer, NULL, producer_thread, NULL) == 0);
+
+        while (ack_ok_cntr < LINES_NUM) {
+                /* give producer a chance to run on single core hosts */
+                if (cat_service(&at) == CAT_STATUS_OK)
+                        sched_yield();
+        }
+
+        assert(pthread_join(producer, NULL) == 0);
+
+        assert(write_cntr == LINES_NUM);
+        while (cat_service(&at) != CAT_STATUS_OK) {};
+
+        /* ring rejects chars when full */
+        assert(cat_feed_input(&at, buf, sizeof(buf)) == sizeof(input_ring_buf));
+        assert(cat_feed_input(&at, buf, 1) == 0);
+
+        return 0;
+}
@@ -0,0 +1,164 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define PORTS_NUM (1000U)
+
+struct port {
+        char input[32];
+        size_t input_pos;
+        char output[32];
+        size_t output_len;
+        bool locked;
+        size_t lock_cntr;
+};
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+PING",
+                .run = cmd_run
+        }
+};
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct port ports[PORTS_NUM];
+static char bufs[PORTS_NUM][32];
+static struct cat_descriptor descs[PORTS_NUM];
+static struct cat_io_interface ifaces[PORTS_NUM];
+static struct cat_mutex_interface mutexes[PORTS_NUM];
+static struct cat_object objects[PORTS_NUM];
+
+/* single io and mutex implementation shared by all ports */
+static int port_write(void *ctx, char ch)
+{
+        struct port *port = ctx;
+
+        assert(port->locked != false);
+        assert(port->output_len < sizeof(port->output) - 1);
+        port->output[port->output_len++] = ch;
+        return 1;
+}
+
+static int port_read(void *ctx, char *ch)
+{
+        struct port *port = ctx;
+
+        assert(port->locked != false);
+        if (port->input[port->input_pos] == 0)
+                return 0;
+
+        *ch = port->input[port->input_pos++];
+        return 1;
+}
+
+static int port_lock(void *ctx)
+{
+        struct port *port = ctx;
+
+        assert(port->locked == false);
+        port->locked = true;
+        port->lock_cntr++;
+        return 0;
+}
+
+static int port_unlock(void *ctx)
+{
+        struct port *port = ctx;
+
+        assert(port->locked != false);
+        port->locked = false;
+        return 0;
+}
+
+int main(int argc, char **argv)
+{
+        size_t i;
+        size_t j;
+        size_t busy;
+        char expected[32];
+
+        for (i = 0; i < PORTS_NUM; i++) {
+                /* every port sends different number of commands */
+                for (j = 0; j <= i % 3; j++)
+                        strcat(ports[i].input, "AT+PING\n");
+
+                descs[i].cmd_group = cmd_desc;
+                descs[i].cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]);
+                descs[i].buf = (uint8_t *)bufs[i];
+                descs[i].buf_size = sizeof(bufs[i]);
+
+                ifaces[i].ctx = &ports[i];
+                ifaces[i].write_ctx = port_write;
+                ifaces[i].read_ctx = port_read;
+
+                mutexes[i].ctx = &ports[i];
+                mutexes[i].lock_ctx = port_lock;
+                mutexes[i].unlock_ctx = port_unlock;
+
+                cat_init(&objects[i], &descs[i], &ifaces[i], &mutexes[i]);
+        }
+
+        /* all instances are driven round robin from one table */
+        do {
+                busy = 0;
+                for (i = 0; i < PORTS_NUM; i++) {
+                        if (cat_service(&objects[i]) != CAT_STATUS_OK)
+                                busy++;
+                }
+        } while (busy > 0);
+
+        for (i = 0; i < PORTS_NUM; i++) {
+                expected[0] = 0;
+                for (j = 0; j <= i % 3; j++)
+                        strcat(expected, "\nOK\n");
+
+                assert(strcmp(ports[i].output, expected) == 0);
+                assert(ports[i].input[ports[i].input_pos] == 0);
+                assert(ports[i].locked == false);
+                assert(ports[i].lock_cntr > 0);
+        }
+
+        return 0;
+}
@@ -0,0 +1,252 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char run_results[256];
+static char ack_results[512];
+
+static uint8_t var_x;
+static char var_msg[16];
+
+static char const *input_text;
+static size_t input_index;
+static char const *write_data;
+static bool writable = true;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        strcat(run_results, " R_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state cmd_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        char tmp[32];
+
+        write_data = (const char *)data;
+
+        sprintf(tmp, " W_%s_%d:", cmd->name, (int)args_num);
+        strcat(run_results, tmp);
+        strncat(run_results, (const char *)data, data_size);
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state cmd_hold(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        return CAT_RETURN_STATE_HOLD;
+}
+
+static struct cat_variable vars[] = {
+        {
+                .type = CAT_VAR_UINT_DEC,
+                .data = &var_x,
+                .data_size = sizeof(var_x),
+                .name = "X"
+        },
+        {
+                .type = CAT_VAR_BUF_STRING,
+                .data = var_msg,
+                .data_size = sizeof(var_msg),
+                .name = "MSG"
+        }
+};
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+RUN",
+                .run = cmd_run
+        },
+        {
+                .name = "+SET",
+                .write = cmd_write,
+                .var = vars,
+                .var_num = sizeof(vars) / sizeof(vars[0])
+        },
+        {
+                .name = "+RAW",
+                .write = cmd_write
+        },
+        {
+                .name = "+HOLD",
+                .write = cmd_hold
+        },
+};
+
+static char buf[128];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf)
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+
+        if (writable == false)
+                return 0;
+
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+
+        memset(run_results, 0, sizeof(run_results));
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char *test_lines[] = {
+        "AT+RUN",
+        "AT+SET=1,\"a,b\"\r\n",
+        "AT+SET=300",
+        "AT+SET?",
+        "AT+SET=?",
+        "at+raw=xyz,\"1\"",
+        "AT+RAW=",
+        "AT+R",
+        "ATX",
+        "",
+        "AT",
+        "AT+S=2,\"c\"\r",
+};
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        static char service_run[256], service_ack[512];
+        static char line[64];
+        size_t i;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        for (i = 0; i < sizeof(test_lines) / sizeof(test_lines[0]); i++) {
+                strcpy(line, test_lines[i]);
+                if ((strlen(line) == 0) || (line[strlen(line) - 1] != '\n'))
+                        strcat(line, "\n");
+
+                prepare_input(line);
+                while (cat_service(&at) != 0) {};
+                strcpy(service_run, run_results);
+                strcpy(service_ack, ack_results);
+
+                prepare_input("");
+                assert(cat_process_line(&at, test_lines[i], strlen(test_lines[i])) == CAT_STATUS_OK);
+                assert(strcmp(ack_results, service_ack) == 0);
+                assert(strcmp(run_results, service_run) == 0);
+        }
+
+        /* arguments are passed to handler straight from caller memory */
+        strcpy(line, "AT+RAW=abc");
+        prepare_input("");
+        assert(cat_process_line(&at, line, strlen(line)) == CAT_STATUS_OK);
+        assert(write_data == &line[7]);
+        assert(strcmp(run_results, " W_+RAW_0:abc") == 0);
+        assert(strcmp(ack_results, "\nOK\n") == 0);
+
+        strcpy(line, "AT+SET=7,\"msg\"");
+        prepare_input("");
+        assert(cat_process_line(&at, line, 9) == CAT_STATUS_OK);
+        assert(strcmp(ack_results, "\nERROR\n") == 0);
+        assert(cat_process_line(&at, line, strlen(line)) == CAT_STATUS_OK);
+        assert(var_x == 7);
+        assert(strcmp(var_msg, "msg") == 0);
+
+        strcpy(line, "AT+HOLD=1");
+        prepare_input("");
+        assert(cat_process_line(&at, line, strlen(line)) == CAT_STATUS_HOLD);
+        assert(cat_process_line(&at, "AT+RUN", 6) == CAT_STATUS_HOLD);
+        assert(cat_hold_exit(&at, CAT_STATUS_OK) == CAT_STATUS_OK);
+        while (cat_service(&at) != 0) {};
+        assert(strcmp(ack_results, "\nOK\n") == 0);
+
+        /* leading new line chars are skipped and commands after embedded new line are parsed */
+        prepare_input("");
+        assert(cat_process_line(&at, "\rAT+RUN", 7) == CAT_STATUS_OK);
+        assert(strcmp(run_results, " R_+RUN") == 0);
+        assert(strstr(ack_results, "OK") != NULL);
+
+        strcpy(line, "AT+RAW=ab\nAT+RUN");
+        prepare_input("");
+        assert(cat_process_line(&at, line, strlen(line)) == CAT_STATUS_OK);
+        assert(strcmp(run_results, " W_+RAW_0:ab R_+RUN") == 0);
+        assert(strcmp(ack_results, "\nOK\n\nOK\n") == 0);
+
+        /* blocked output does not lock caller, rest of line is continued by service */
+        strcpy(line, "AT+RUN\nAT+RAW=q");
+        prepare_input("");
+        writable = false;
+        assert(cat_process_line(&at, line, strlen(line)) == CAT_STATUS_BUSY);
+        assert(strcmp(run_results, " R_+RUN") == 0);
+        assert(cat_process_line(&at, "AT+RUN", 6) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_service(&at) == CAT_STATUS_BUSY);
+        writable = true;
+        while (cat_service(&at) != 0) {};
+        assert(strcmp(run_results, " R_+RUN W_+RAW_0:q") == 0);
+        assert(strcmp(ack_results, "\nOK\n\nOK\n") == 0);
+
+        return 0;
+}
@@ -0,0 +1,221 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char run_results[256];
+static char ack_results[512];
+
+static uint8_t var_x;
+static char var_msg[16];
+
+static char const *input_text;
+static size_t input_index;
+static size_t block_size;
+static size_t block_reads;
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        strcat(run_results, " R_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state cmd_write(const struct cat_command *cmd, const uint8_t *data, const size_t data_size, const size_t args_num)
+{
+        strcat(run_results, " W_");
+        strcat(run_results, cmd->name);
+        strcat(run_results, ":");
+        strncat(run_results, (const char *)data, data_size);
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_variable vars[] = {
+        {
+                .type = CAT_VAR_UINT_DEC,
+                .data = &var_x,
+                .data_size = sizeof(var_x),
+                .name = "X"
+        },
+        {
+                .type = CAT_VAR_BUF_STRING,
+                .data = var_msg,
+                .data_size = sizeof(var_msg),
+                .name = "MSG"
+        }
+};
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+RUN",
+                .run = cmd_run
+        },
+        {
+                .name = "+SET",
+                .write = cmd_write,
+                .var = vars,
+                .var_num = sizeof(vars) / sizeof(vars[0])
+        },
+};
+
+static char buf[128];
+static char input_buf[5];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf)
+};
+
+static struct cat_descriptor block_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .input_buf = input_buf,
+        .input_buf_size = sizeof(input_buf)
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static size_t read_block(char *data, size_t max_size)
+{
+        size_t n = strlen(input_text) - input_index;
+
+        if (n > max_size)
+                n = max_size;
+        if (n > block_size)
+                n = block_size;
+
+        memcpy(data, &input_text[input_index], n);
+        input_index += n;
+
+        if (n > 0)
+                block_reads++;
+        return n;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static struct cat_io_interface block_iface = {
+        .write = write_char,
+        .read_block = read_block
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+        block_reads = 0;
+
+        memset(run_results, 0, sizeof(run_results));
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char test_case_1[] = "\nAT+RUN\r\nat+set=1,\"ab\"\nAT+SE?\nAT+SET=?\nAT+XX\nAT+R\nAT+SET=300\n";
+
+static size_t run_test_case(struct cat_object *self, const char *text, char *run_out, char *ack_out)
+{
+        size_t service_cntr = 0;
+
+        prepare_input(text);
+        while (cat_service(self) != 0)
+                service_cntr++;
+
+        strcpy(run_out, run_results);
+        strcpy(ack_out, ack_results);
+        return service_cntr;
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        struct cat_object at_block;
+        static char char_run[256], char_ack[512];
+        static char block_run[256], block_ack[512];
+        size_t char_service_cntr;
+        size_t block_service_cntr;
+
+        cat_init(&at, &desc, &iface, NULL);
+        cat_init(&at_block, &block_desc, &block_iface, NULL);
+
+        char_service_cntr = run_test_case(&at, test_case_1, char_run, char_ack);
+
+        for (block_size = 1; block_size <= sizeof(input_buf); block_size++) {
+                block_service_cntr = run_test_case(&at_block, test_case_1, block_run, block_ack);
+
+                assert(strcmp(block_ack, char_ack) == 0);
+                assert(strcmp(block_run, char_run) == 0);
+                assert(block_reads == (strlen(test_case_1) + block_size - 1) / block_size);
+                assert(block_service_cntr <= char_service_cntr);
+        }
+
+        /* whole staged block is parsed within single service call */
+        assert(block_service_cntr < char_service_cntr);
+
+        assert(strcmp(char_run, " R_+RUN W_+SET:1,\"ab\" R_+RUN") == 0);
+
+        return 0;
+}
@@ -0,0 +1,218 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char run_results[256];
+static char ack_results[512];
+
+static char const *input_text;
+static size_t input_index;
+
+static uint32_t time_us;
+static uint32_t tick_us;
+
+static struct cat_object at;
+static struct cat_command cmds[];
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        strcat(run_results, " R_");
+        strcat(run_results, cmd->name);
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state cmd_hold(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_HOLD;
+}
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        if (strcmp(cmd->name, "+EVT") == 0)
+                assert(cat_trigger_unsolicited_read(&at, &cmds[2]) == CAT_STATUS_OK);
+
+        strcpy((char *)data, cmd->name);
+        *data_size = strlen(cmd->name);
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+RUN",
+                .run = cmd_run
+        },
+        {
+                .name = "+HOLD",
+                .run = cmd_hold
+        },
+        {
+                .name = "+READ",
+                .read = cmd_read
+        },
+        {
+                .name = "+EVT",
+                .read = cmd_read
+        },
+};
+
+static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static uint32_t get_time_us(void)
+{
+        time_us += tick_us;
+        return time_us;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static struct cat_clock_interface clock_iface = {
+        .get_time_us = get_time_us
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+
+        memset(run_results, 0, sizeof(run_results));
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char test_case_1[] = "\nAT+RUN\nAT+READ?\r\nAT+EVT?\nATX\n\nAT+R\n";
+static const char test_case_2[] = "\nAT+HOLD\n";
+
+int main(int argc, char **argv)
+{
+        static char service_run[256], service_ack[512];
+        struct cat_service_stats stats;
+        size_t slice_cntr;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        prepare_input(test_case_1);
+        while (cat_service(&at) != 0) {};
+        strcpy(service_run, run_results);
+        strcpy(service_ack, ack_results);
+
+        /* budget cannot be measured without clock */
+        prepare_input(test_case_1);
+        assert(cat_service_timed(&at, 100000) == CAT_STATUS_ERROR);
+        assert(input_index == 0);
+        assert(strlen(ack_results) == 0);
+
+        assert(cat_set_clock_interface(&at, &clock_iface) == CAT_STATUS_OK);
+
+        /* every step takes 10us, so slice yields after 4 steps */
+        tick_us = 10;
+        time_us = 0xFFFFFFF0U;
+
+        prepare_input(test_case_1);
+        slice_cntr = 1;
+        while (cat_service_timed(&at, 35) != CAT_STATUS_OK)
+                slice_cntr++;
+
+        assert(slice_cntr > 1);
+        assert(strcmp(ack_results, service_ack) == 0);
+        assert(strcmp(run_results, service_run) == 0);
+
+        assert(cat_get_service_stats(&at, &stats, true) == CAT_STATUS_OK);
+        assert(stats.slice_cntr == slice_cntr);
+        assert(stats.step_max_us == 10);
+        assert(stats.slice_max_us == 40);
+        assert(stats.overrun_cntr > 0);
+        assert(stats.overrun_cntr < slice_cntr);
+
+        assert(cat_get_service_stats(&at, &stats, false) == CAT_STATUS_OK);
+        assert(stats.slice_cntr == 0);
+        assert(stats.slice_max_us == 0);
+
+        /* whole input is processed within big enough budget */
+        prepare_input(test_case_1);
+        assert(cat_service_timed(&at, 100000) == CAT_STATUS_OK);
+        assert(strcmp(ack_results, service_ack) == 0);
+
+        /* hold state yields before budget expires */
+        prepare_input(test_case_2);
+        assert(cat_service_timed(&at, 100000) == CAT_STATUS_BUSY);
+        assert(cat_hold_exit(&at, CAT_STATUS_OK) == CAT_STATUS_OK);
+        assert(cat_service_timed(&at, 100000) == CAT_STATUS_OK);
+        assert(strcmp(ack_results, "\nOK\n") == 0);
+
+        assert(cat_get_service_stats(&at, &stats, false) == CAT_STATUS_OK);
+        assert(stats.slice_cntr == 3);
+        assert(stats.overrun_cntr == 0);
+
+        return 0;
+}
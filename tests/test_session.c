@@ -0,0 +1,224 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+struct session_io {
+        const char *input;
+        char output[128];
+};
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        *data_size += sprintf((char *)&data[*data_size], "%u", (unsigned)max_data_size);
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+SIZE",
+                .read = cmd_read
+        },
+        {
+                .name = "+RUN",
+                .run = cmd_run
+        },
+        {
+                .name = "+SET",
+                .run = cmd_run
+        }
+};
+
+static struct cat_command_index cmd_index[3];
+static struct cat_command_index cmd_addr_index[8];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+/* shared descriptor without any per session storage */
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .cmd_index = cmd_index,
+        .cmd_index_num = sizeof(cmd_index) / sizeof(cmd_index[0]),
+
+        .cmd_addr_index = cmd_addr_index,
+        .cmd_addr_index_num = sizeof(cmd_addr_index) / sizeof(cmd_addr_index[0])
+};
+
+static int write_char(void *ctx, char ch)
+{
+        struct session_io *io = ctx;
+        size_t len = strlen(io->output);
+
+        assert(len < sizeof(io->output) - 1);
+        io->output[len] = ch;
+        io->output[len + 1] = 0;
+        return 1;
+}
+
+static int read_char(void *ctx, char *ch)
+{
+        struct session_io *io = ctx;
+
+        if (*io->input == 0)
+                return 0;
+
+        *ch = *io->input++;
+        return 1;
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_table table;
+        struct cat_object at1;
+        struct cat_object at2;
+        struct cat_object at3;
+        uint8_t buf1[32];
+        uint8_t buf2[64];
+        uint8_t buf3[32];
+        uint8_t unsolicited_buf1[16];
+        struct cat_unsolicited_fsm unsolicited_fsm1;
+        struct cat_unsolicited_fsm unsolicited_fsm2;
+        struct cat_unsolicited_queue_stats stats;
+        struct cat_unsolicited_cmd unsolicited_cmd_buf1[2];
+        atomic_uchar unsolicited_pending_buf1[CAT_UNSOLICITED_PENDING_BUF_SIZE(3)];
+        struct cat_session_config config1 = {
+                .buf = buf1,
+                .buf_size = sizeof(buf1),
+                .unsolicited_buf = unsolicited_buf1,
+                .unsolicited_buf_size = sizeof(unsolicited_buf1),
+                .unsolicited_fsm = &unsolicited_fsm1,
+                .unsolicited_cmd_buf = unsolicited_cmd_buf1,
+                .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf1) / sizeof(unsolicited_cmd_buf1[0]),
+                .unsolicited_pending_buf = unsolicited_pending_buf1,
+                .unsolicited_pending_buf_size = sizeof(unsolicited_pending_buf1)
+        };
+        struct cat_session_config config2 = {
+                .buf = buf2,
+                .buf_size = sizeof(buf2),
+                .unsolicited_fsm = &unsolicited_fsm2
+        };
+        /* session without unsolicited events support */
+        struct cat_session_config config3 = {
+                .buf = buf3,
+                .buf_size = sizeof(buf3)
+        };
+        struct session_io io1 = {
+                .input = "AT+SIZE?\nAT+RUN\n"
+        };
+        struct session_io io2 = {
+                .input = "AT+SIZE?\nAT+S\nAT+SE\n"
+        };
+        struct session_io io3 = {
+                .input = "AT+RUN\n"
+        };
+        struct cat_io_interface iface1 = {
+                .ctx = &io1,
+                .read_ctx = read_char,
+                .write_ctx = write_char
+        };
+        struct cat_io_interface iface2 = {
+                .ctx = &io2,
+                .read_ctx = read_char,
+                .write_ctx = write_char
+        };
+        struct cat_io_interface iface3 = {
+                .ctx = &io3,
+                .read_ctx = read_char,
+                .write_ctx = write_char
+        };
+        cat_status s1;
+        cat_status s2;
+
+        cat_table_init(&table, &desc);
+        assert(table.desc == &desc);
+        assert(table.commands_num == 3);
+
+        cat_init_session(&at1, &table, &config1, &iface1, NULL);
+        cat_init_session(&at2, &table, &config2, &iface2, NULL);
+
+        assert(cat_search_command_by_name(&at1, "+RUN") == &cmds[1]);
+        assert(cat_search_command_by_name(&at2, "+SET") == &cmds[2]);
+
+        /* sessions are serviced alternately with own working buffers and states */
+        do {
+                s1 = cat_service(&at1);
+                s2 = cat_service(&at2);
+        } while ((s1 != CAT_STATUS_OK) || (s2 != CAT_STATUS_OK));
+
+        assert(strcmp(io1.output, "\n+SIZE=32\n\nOK\n\nOK\n") == 0);
+        assert(strcmp(io2.output, "\n+SIZE=32\n\nOK\n\nERROR\n\nOK\n") == 0);
+
+        /* unsolicited events of every session are independent */
+        assert(cat_trigger_unsolicited_read(&at1, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_event_buffered(&at2, &cmds[0], CAT_CMD_TYPE_READ) == CAT_STATUS_OK);
+
+        /* first session has own pending bitmap and queue, second one only internal single event buffer */
+        assert(cat_trigger_unsolicited_read(&at1, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_test(&at1, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_buffer_full(&at1) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_trigger_unsolicited_test(&at2, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_buffer_full(&at2) == CAT_STATUS_ERROR_BUFFER_FULL);
+
+        io1.output[0] = 0;
+        while (cat_service(&at1) != CAT_STATUS_OK) {};
+        assert(strcmp(io1.output, "\n+SIZE=16\n\n+SIZE=\n") == 0);
+        assert(strcmp(io2.output, "\n+SIZE=32\n\nOK\n\nERROR\n\nOK\n") == 0);
+
+        /* session without unsolicited fsm storage parses commands, its unsolicited buffer has no capacity */
+        cat_init_session(&at3, &table, &config3, &iface3, NULL);
+        while (cat_service(&at3) != CAT_STATUS_OK) {};
+        assert(strcmp(io3.output, "\nOK\n") == 0);
+
+        assert(cat_trigger_unsolicited_read(&at3, &cmds[0]) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_trigger_unsolicited_snapshot(&at3, &cmds[0], "1", CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_is_unsolicited_buffer_full(&at3) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_is_unsolicited_event_buffered(&at3, &cmds[0], CAT_CMD_TYPE_NONE) == CAT_STATUS_OK);
+        assert(cat_get_processed_command(&at3, CAT_FSM_TYPE_UNSOLICITED) == NULL);
+        assert(cat_get_unsolicited_queue_stats(&at3, CAT_UNSOLICITED_PRIORITY_NORMAL, &stats, false) == CAT_STATUS_OK);
+        assert(stats.capacity == 0);
+        assert(cat_service(&at3) == CAT_STATUS_OK);
+
+        return 0;
+}
@@ -0,0 +1,221 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char read_results[256];
+static char ack_results[512];
+static size_t write_cntr;
+static int var_value;
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        strcat(read_results, " ");
+        strcat(read_results, cmd->name);
+
+        if (strcmp(cmd->name, "+ERR") == 0)
+                return CAT_RETURN_STATE_ERROR;
+        if (strcmp(cmd->name, "+NONE") == 0)
+                return CAT_RETURN_STATE_OK;
+
+        *data_size += sprintf((char *)&data[*data_size], "%d", var_value++);
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+A",
+                .read = cmd_read
+        },
+        {
+                .name = "+B",
+                .read = cmd_read
+        },
+        {
+                .name = "+LONGER_NAME",
+                .read = cmd_read
+        },
+        {
+                .name = "+ERR",
+                .read = cmd_read
+        },
+        {
+                .name = "+NONE",
+                .read = cmd_read
+        }
+};
+
+static char buf[64];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static char unsolicited_buf[24];
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[8];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_buf = unsolicited_buf,
+        .unsolicited_buf_size = sizeof(unsolicited_buf),
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+
+        .unsolicited_batch = true
+};
+
+static struct cat_descriptor single_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_buf = unsolicited_buf,
+        .unsolicited_buf_size = sizeof(unsolicited_buf),
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0])
+};
+
+static size_t write_iov(const struct cat_io_vec *iov, size_t iov_num)
+{
+        size_t i;
+        size_t n = 0;
+
+        for (i = 0; i < iov_num; i++) {
+                strncat(ack_results, iov[i].base, iov[i].len);
+                n += iov[i].len;
+        }
+        /* each call is single output transaction */
+        strcat(ack_results, "|");
+        write_cntr++;
+        return n;
+}
+
+static int read_char(char *ch)
+{
+        return 0;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write_iov = write_iov
+};
+
+static void prepare_results(void)
+{
+        memset(ack_results, 0, sizeof(ack_results));
+        memset(read_results, 0, sizeof(read_results));
+        write_cntr = 0;
+        var_value = 1;
+}
+
+static void trigger(struct cat_object *self, size_t index)
+{
+        assert(cat_trigger_unsolicited_read(self, &cmds[index]) == CAT_STATUS_OK);
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+
+        /* without batching every event is flushed separately */
+        cat_init(&at, &single_desc, &iface, NULL);
+        prepare_results();
+        trigger(&at, 0);
+        trigger(&at, 1);
+        trigger(&at, 0);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+A=1\n|\n+B=2\n|\n+A=3\n|") == 0);
+        assert(write_cntr == 3);
+
+        /* queued events are formatted together and flushed in single transaction */
+        cat_init(&at, &desc, &iface, NULL);
+        prepare_results();
+        trigger(&at, 0);
+        trigger(&at, 1);
+        trigger(&at, 0);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+A=1\n\n+B=2\n\n+A=3\n|") == 0);
+        assert(strcmp(read_results, " +A +B +A") == 0);
+        assert(write_cntr == 1);
+
+        /* event which does not fit is formatted again after batch flush */
+        prepare_results();
+        trigger(&at, 0);
+        trigger(&at, 1);
+        trigger(&at, 2);
+        trigger(&at, 0);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+A=1\n\n+B=2\n|\n+LONGER_NAME=3\n\n+A=4\n|") == 0);
+        assert(strcmp(read_results, " +A +B +LONGER_NAME +A") == 0);
+
+        /* events without response or with error are skipped (failed one is retried once) */
+        prepare_results();
+        trigger(&at, 0);
+        trigger(&at, 4);
+        trigger(&at, 1);
+        trigger(&at, 3);
+        trigger(&at, 0);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+A=1\n\n+B=2\n|\n+A=3\n|") == 0);
+        assert(strcmp(read_results, " +A +NONE +B +ERR +ERR +A") == 0);
+
+        /* single event is flushed without waiting */
+        prepare_results();
+        trigger(&at, 1);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+B=1\n|") == 0);
+
+        return 0;
+}
@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char read_results[256];
+static char ack_results[256];
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        strcat(read_results, " read:");
+        strcat(read_results, cmd->name);
+
+        *data_size = 0;
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+CMD",
+                .read = cmd_read
+        }
+};
+
+static struct cat_command u_cmds[] = {
+        {
+                .name = "+U1",
+                .read = cmd_read
+        },
+        {
+                .name = "+U2",
+                .read = cmd_read
+        },
+        {
+                .name = "+U3",
+                .read = cmd_read
+        }
+};
+
+static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static char ctrl_buf[128];
+static struct cat_unsolicited_fsm ctrl_unsolicited_fsm;
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[4];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0])
+};
+
+static struct cat_descriptor ctrl_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = ctrl_buf,
+        .buf_size = sizeof(ctrl_buf),
+
+        .unsolicited_fsm = &ctrl_unsolicited_fsm
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        return 0;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void prepare_results(void)
+{
+        memset(ack_results, 0, sizeof(ack_results));
+        memset(read_results, 0, sizeof(read_results));
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        struct cat_object ctrl;
+        size_t i;
+
+        cat_init(&at, &desc, &iface, NULL);
+        cat_init(&ctrl, &ctrl_desc, &iface, NULL);
+
+        /* queue depth is taken from descriptor */
+        prepare_results();
+        assert(cat_trigger_unsolicited_read(&at, &u_cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_test(&at, &u_cmds[1]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &u_cmds[2]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_buffer_full(&at) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &u_cmds[1]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_buffer_full(&at) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_trigger_unsolicited_read(&at, &u_cmds[0]) == CAT_STATUS_ERROR_BUFFER_FULL);
+
+        assert(cat_is_unsolicited_event_buffered(&at, &u_cmds[1], CAT_CMD_TYPE_TEST) == CAT_STATUS_BUSY);
+        assert(cat_is_unsolicited_event_buffered(&at, &u_cmds[2], CAT_CMD_TYPE_TEST) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_event_buffered(&at, &u_cmds[2], CAT_CMD_TYPE_READ) == CAT_STATUS_BUSY);
+
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+U1=\n\n+U2=\n\n+U3=\n\n+U2=\n") == 0);
+        assert(strcmp(read_results, " read:+U1 read:+U3 read:+U2") == 0);
+        assert(cat_is_unsolicited_buffer_full(&at) == CAT_STATUS_OK);
+
+        /* many laps over descriptor storage */
+        prepare_results();
+        for (i = 0; i < 10; i++) {
+                assert(cat_trigger_unsolicited_read(&at, &u_cmds[i % 3]) == CAT_STATUS_OK);
+                while (cat_service(&at) != 0) {};
+        }
+        assert(strcmp(read_results, " read:+U1 read:+U2 read:+U3 read:+U1 read:+U2 read:+U3 read:+U1 read:+U2 read:+U3 read:+U1") == 0);
+
+        /* object without descriptor storage keeps default depth */
+        prepare_results();
+        assert(cat_trigger_unsolicited_read(&ctrl, &u_cmds[0]) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_buffer_full(&ctrl) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_trigger_unsolicited_read(&ctrl, &u_cmds[1]) == CAT_STATUS_ERROR_BUFFER_FULL);
+
+        while (cat_service(&ctrl) != 0) {};
+
+        assert(strcmp(ack_results, "\n+U1=\n") == 0);
+        assert(cat_is_unsolicited_buffer_full(&ctrl) == CAT_STATUS_OK);
+
+        return 0;
+}
@@ -0,0 +1,210 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define PRODUCERS_NUM (8U)
+#define TRIGGERS_NUM (20000U)
+#define DUPLICATES_ROUNDS_NUM (2000U)
+#define CMDS_NUM (3U)
+
+static struct cat_object at;
+
+/* stamp taken before every trigger, processing must see stamp of every accepted trigger */
+static atomic_size_t stamp;
+static atomic_size_t accepted_stamp[CMDS_NUM];
+static size_t processed_stamp[CMDS_NUM];
+static atomic_size_t producers_done;
+static atomic_size_t duplicates_round;
+static atomic_size_t duplicates_done;
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size);
+
+static struct cat_command cmds[CMDS_NUM] = {
+        { .name = "+C0", .read = cmd_read },
+        { .name = "+C1", .read = cmd_read },
+        { .name = "+C2", .read = cmd_read },
+};
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        processed_stamp[cmd - cmds] = atomic_load(&stamp);
+        *data_size = 0;
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[2];
+static struct cat_command_index cmd_addr_index[8];
+static atomic_uchar unsolicited_pending_buf[CAT_UNSOLICITED_PENDING_BUF_SIZE(3)];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        /* very short queue, so triggers are often rejected */
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+
+        .cmd_addr_index = cmd_addr_index,
+        .cmd_addr_index_num = sizeof(cmd_addr_index) / sizeof(cmd_addr_index[0]),
+
+        .unsolicited_pending_buf = unsolicited_pending_buf,
+        .unsolicited_pending_buf_size = sizeof(unsolicited_pending_buf)
+};
+
+static int write_char(char ch)
+{
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        return 0;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void* producer_thread(void *arg)
+{
+        size_t id = (size_t)arg;
+        size_t i;
+        size_t n;
+        size_t c;
+        size_t prev;
+
+        for (i = 0; i < TRIGGERS_NUM; i++) {
+                c = (id + i) % CMDS_NUM;
+                n = atomic_fetch_add(&stamp, 1) + 1;
+                /* trigger merged into rejected one is dropped with it, so rejected trigger is repeated */
+                while (cat_trigger_unsolicited_read(&at, &cmds[c]) != CAT_STATUS_OK)
+                        sched_yield();
+
+                /* accepted (buffered or merged) trigger */
+                prev = atomic_load(&accepted_stamp[c]);
+                while ((n > prev) && (atomic_compare_exchange_weak(&accepted_stamp[c], &prev, n) == false)) {};
+        }
+
+        atomic_fetch_add(&producers_done, 1);
+        return NULL;
+}
+
+static void* duplicate_producer_thread(void *arg)
+{
+        size_t round;
+
+        for (round = 1; round <= DUPLICATES_ROUNDS_NUM; round++) {
+                /* all producers start round together to race for the same pending event */
+                while (atomic_load(&duplicates_round) < round)
+                        sched_yield();
+
+                /* duplicate never takes queue cell, so it is never rejected */
+                assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+                atomic_fetch_add(&duplicates_done, 1);
+        }
+
+        return NULL;
+}
+
+int main(int argc, char **argv)
+{
+        pthread_t producers[PRODUCERS_NUM];
+        size_t i;
+        size_t round;
+        struct cat_unsolicited_queue_stats stats;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        /* concurrent duplicates of pending event take single queue cell */
+        for (i = 0; i < PRODUCERS_NUM; i++)
+                assert(pthread_create(&producers[i], NULL, duplicate_producer_thread, NULL) == 0);
+
+        for (round = 1; round <= DUPLICATES_ROUNDS_NUM; round++) {
+                atomic_store(&duplicates_round, round);
+                while (atomic_load(&duplicates_done) < round * PRODUCERS_NUM)
+                        sched_yield();
+
+                assert(cat_get_unsolicited_queue_stats(&at, CAT_UNSOLICITED_PRIORITY_NORMAL, &stats, true) == CAT_STATUS_OK);
+                assert(stats.depth == 1);
+                assert(stats.high_water_mark == 1);
+                assert(stats.capacity - stats.depth == sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]) - 1);
+
+                while (cat_service(&at) != CAT_STATUS_OK) {};
+                assert(cat_get_unsolicited_queue_stats(&at, CAT_UNSOLICITED_PRIORITY_NORMAL, &stats, true) == CAT_STATUS_OK);
+                assert(stats.depth == 0);
+        }
+
+        for (i = 0; i < PRODUCERS_NUM; i++)
+                assert(pthread_join(producers[i], NULL) == 0);
+
+        for (i = 0; i < PRODUCERS_NUM; i++)
+                assert(pthread_create(&producers[i], NULL, producer_thread, (void *)i) == 0);
+
+        while (atomic_load(&producers_done) < PRODUCERS_NUM) {
+                /* give producers a chance to run on single core hosts */
+                if (cat_service(&at) == CAT_STATUS_OK)
+                        sched_yield();
+        }
+
+        for (i = 0; i < PRODUCERS_NUM; i++)
+                assert(pthread_join(producers[i], NULL) == 0);
+
+        while (cat_service(&at) != CAT_STATUS_OK) {};
+
+        /* merged trigger is never lost (last accepted trigger is followed by processing) */
+        for (i = 0; i < CMDS_NUM; i++) {
+                assert(processed_stamp[i] >= atomic_load(&accepted_stamp[i]));
+                assert(cat_is_unsolicited_event_buffered(&at, &cmds[i], CAT_CMD_TYPE_NONE) == CAT_STATUS_OK);
+        }
+
+        return 0;
+}
@@ -0,0 +1,189 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char read_results[256];
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        strcat(read_results, " ");
+        strcat(read_results, cmd->name);
+
+        *data_size = 0;
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+REPORT",
+                .read = cmd_read
+        },
+        {
+                .name = "+STATE",
+                .read = cmd_read
+        },
+        {
+                .name = "+ALARM",
+                .read = cmd_read
+        }
+};
+
+static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static char shared_buf[128];
+static struct cat_unsolicited_fsm shared_unsolicited_fsm;
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[4];
+static struct cat_unsolicited_cmd unsolicited_low_cmd_buf[4];
+static struct cat_unsolicited_cmd unsolicited_high_cmd_buf[2];
+static struct cat_unsolicited_cmd shared_cmd_buf[4];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+        .unsolicited_low_cmd_buf = unsolicited_low_cmd_buf,
+        .unsolicited_low_cmd_buf_num = sizeof(unsolicited_low_cmd_buf) / sizeof(unsolicited_low_cmd_buf[0]),
+        .unsolicited_high_cmd_buf = unsolicited_high_cmd_buf,
+        .unsolicited_high_cmd_buf_num = sizeof(unsolicited_high_cmd_buf) / sizeof(unsolicited_high_cmd_buf[0])
+};
+
+static struct cat_descriptor shared_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = shared_buf,
+        .buf_size = sizeof(shared_buf),
+
+        .unsolicited_fsm = &shared_unsolicited_fsm,
+
+        .unsolicited_cmd_buf = shared_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(shared_cmd_buf) / sizeof(shared_cmd_buf[0])
+};
+
+static int write_char(char ch)
+{
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        return 0;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static void check_stats(struct cat_object *self, cat_unsolicited_priority priority, size_t depth, size_t hwm, size_t capacity)
+{
+        struct cat_unsolicited_queue_stats stats;
+
+        assert(cat_get_unsolicited_queue_stats(self, priority, &stats, false) == CAT_STATUS_OK);
+        assert(stats.depth == depth);
+        assert(stats.high_water_mark == hwm);
+        assert(stats.capacity == capacity);
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        struct cat_object shared;
+        struct cat_unsolicited_queue_stats stats;
+
+        cat_init(&at, &desc, &iface, NULL);
+        cat_init(&shared, &shared_desc, &iface, NULL);
+
+        memset(read_results, 0, sizeof(read_results));
+
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[0], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_LOW) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[0], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_LOW) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[0], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_LOW) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[1]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[2], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_HIGH) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[2], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_HIGH) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[2], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_HIGH) == CAT_STATUS_ERROR_BUFFER_FULL);
+
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_LOW, 3, 3, 4);
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_NORMAL, 1, 1, 4);
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_HIGH, 2, 2, 2);
+        assert(cat_is_unsolicited_buffer_full(&at) == CAT_STATUS_OK);
+        assert(cat_is_unsolicited_event_buffered(&at, &cmds[0], CAT_CMD_TYPE_READ) == CAT_STATUS_BUSY);
+        assert(cat_is_unsolicited_event_buffered(&at, &cmds[2], CAT_CMD_TYPE_READ) == CAT_STATUS_BUSY);
+
+        /* highest non-empty priority is drained first */
+        while (strlen(read_results) < strlen(" +ALARM +ALARM +STATE +REPORT"))
+                assert(cat_service(&at) == CAT_STATUS_BUSY);
+
+        /* alarm triggered while low priority reports are pending overtakes them */
+        assert(cat_trigger_unsolicited_event_priority(&at, &cmds[2], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_HIGH) == CAT_STATUS_OK);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(read_results, " +ALARM +ALARM +STATE +REPORT +ALARM +REPORT +REPORT") == 0);
+
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_LOW, 0, 3, 4);
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_HIGH, 0, 2, 2);
+        assert(cat_get_unsolicited_queue_stats(&at, CAT_UNSOLICITED_PRIORITY_LOW, &stats, true) == CAT_STATUS_OK);
+        assert(stats.high_water_mark == 3);
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_LOW, 0, 0, 4);
+        check_stats(&at, CAT_UNSOLICITED_PRIORITY_NORMAL, 0, 1, 4);
+
+        /* priorities without own buffer share normal priority buffer */
+        memset(read_results, 0, sizeof(read_results));
+        assert(cat_trigger_unsolicited_event_priority(&shared, &cmds[0], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_LOW) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&shared, &cmds[1]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_event_priority(&shared, &cmds[2], CAT_CMD_TYPE_READ, CAT_UNSOLICITED_PRIORITY_HIGH) == CAT_STATUS_OK);
+        check_stats(&shared, CAT_UNSOLICITED_PRIORITY_LOW, 3, 3, 4);
+        check_stats(&shared, CAT_UNSOLICITED_PRIORITY_HIGH, 3, 3, 4);
+        while (cat_service(&shared) != 0) {};
+
+        assert(strcmp(read_results, " +REPORT +STATE +ALARM") == 0);
+
+        return 0;
+}
@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char ack_results[256];
+static const char *input_text;
+static uint32_t now_us;
+static int var_value;
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        *data_size += sprintf((char *)&data[*data_size], "%d", var_value++);
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+A",
+                .read = cmd_read
+        },
+        {
+                .name = "+B",
+                .run = cmd_run
+        }
+};
+
+static char buf[64];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[2];
+static struct cat_unsolicited_cmd line_unsolicited_cmd_buf[4];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor byte_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+
+        .unsolicited_rate = 1000,
+        .unsolicited_rate_burst = 10,
+        .unsolicited_rate_unit = CAT_UNSOLICITED_RATE_UNIT_BYTE
+};
+
+static struct cat_descriptor line_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_cmd_buf = line_unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(line_unsolicited_cmd_buf) / sizeof(line_unsolicited_cmd_buf[0]),
+
+        .unsolicited_rate = 1,
+        .unsolicited_rate_burst = 1,
+        .unsolicited_rate_unit = CAT_UNSOLICITED_RATE_UNIT_LINE
+};
+
+static size_t write_iov(const struct cat_io_vec *iov, size_t iov_num)
+{
+        size_t i;
+        size_t n = 0;
+
+        for (i = 0; i < iov_num; i++) {
+                strncat(ack_results, iov[i].base, iov[i].len);
+                n += iov[i].len;
+        }
+        /* each call is single output transaction */
+        strcat(ack_results, "|");
+        return n;
+}
+
+static int read_char(char *ch)
+{
+        if ((input_text == NULL) || (*input_text == 0))
+                return 0;
+
+        *ch = *input_text++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write_iov = write_iov
+};
+
+static uint32_t get_time_us(void)
+{
+        return now_us;
+}
+
+static struct cat_clock_interface clock_iface = {
+        .get_time_us = get_time_us
+};
+
+static void prepare_results(void)
+{
+        memset(ack_results, 0, sizeof(ack_results));
+        input_text = NULL;
+        var_value = 1;
+}
+
+static void service(struct cat_object *self, size_t steps)
+{
+        while (steps-- > 0)
+                cat_service(self);
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        struct cat_unsolicited_rate_stats stats;
+
+        /* without clock interface rate is not limited */
+        cat_init(&at, &byte_desc, &iface, NULL);
+        prepare_results();
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+A=1\n|\n+A=2\n|") == 0);
+        assert(cat_get_unsolicited_rate_stats(&at, &stats, false) == CAT_STATUS_OK);
+        assert(stats.deferred_cntr == 0);
+        assert(stats.dropped_cntr == 0);
+
+        /* events exceeding queue depth are dropped */
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_ERROR_BUFFER_FULL);
+        assert(cat_get_unsolicited_rate_stats(&at, &stats, true) == CAT_STATUS_OK);
+        assert(stats.dropped_cntr == 1);
+        assert(cat_get_unsolicited_rate_stats(&at, &stats, false) == CAT_STATUS_OK);
+        assert(stats.dropped_cntr == 0);
+
+        /* second response (6 bytes) waits for tokens, but command response is not delayed */
+        cat_init(&at, &byte_desc, &iface, NULL);
+        cat_set_clock_interface(&at, &clock_iface);
+        prepare_results();
+        now_us = 1000;
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        service(&at, 20);
+
+        assert(strcmp(ack_results, "\n+A=1\n|") == 0);
+        assert(cat_service(&at) == CAT_STATUS_BUSY);
+
+        input_text = "AT+B\n";
+        service(&at, 20);
+
+        assert(strcmp(ack_results, "\n+A=1\n|\nOK\n|") == 0);
+
+        now_us += 1000;
+        service(&at, 20);
+        assert(strcmp(ack_results, "\n+A=1\n|\nOK\n|") == 0);
+
+        now_us += 1000;
+        while (cat_service(&at) != 0) {};
+        assert(strcmp(ack_results, "\n+A=1\n|\nOK\n|\n+A=2\n|") == 0);
+
+        assert(cat_get_unsolicited_rate_stats(&at, &stats, false) == CAT_STATUS_OK);
+        assert(stats.deferred_cntr == 1);
+        assert(stats.dropped_cntr == 0);
+
+        /* single line per second */
+        cat_init(&at, &line_desc, &iface, NULL);
+        cat_set_clock_interface(&at, &clock_iface);
+        prepare_results();
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        service(&at, 20);
+
+        assert(strcmp(ack_results, "\n+A=1\n|") == 0);
+
+        now_us += 999999;
+        service(&at, 20);
+        assert(strcmp(ack_results, "\n+A=1\n|") == 0);
+
+        now_us += 1;
+        service(&at, 20);
+        assert(strcmp(ack_results, "\n+A=1\n|\n+A=2\n|") == 0);
+
+        now_us += 1000000;
+        while (cat_service(&at) != 0) {};
+        assert(strcmp(ack_results, "\n+A=1\n|\n+A=2\n|\n+A=3\n|") == 0);
+
+        assert(cat_get_unsolicited_rate_stats(&at, &stats, true) == CAT_STATUS_OK);
+        assert(stats.deferred_cntr == 2);
+        assert(cat_get_unsolicited_rate_stats(&at, &stats, false) == CAT_STATUS_OK);
+        assert(stats.deferred_cntr == 0);
+
+        return 0;
+}
@@ -0,0 +1,201 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+#define PRODUCERS_NUM (8U)
+#define EVENTS_NUM (2000U)
+
+static struct cat_object at;
+static pthread_t consumer;
+
+static atomic_size_t sent_cntr[PRODUCERS_NUM];
+static size_t received_cntr[PRODUCERS_NUM];
+static size_t received_total;
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size);
+
+static struct cat_command u_cmds[PRODUCERS_NUM] = {
+        { .name = "+U0", .read = cmd_read },
+        { .name = "+U1", .read = cmd_read },
+        { .name = "+U2", .read = cmd_read },
+        { .name = "+U3", .read = cmd_read },
+        { .name = "+U4", .read = cmd_read },
+        { .name = "+U5", .read = cmd_read },
+        { .name = "+U6", .read = cmd_read },
+        { .name = "+U7", .read = cmd_read },
+};
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        size_t id = cmd - u_cmds;
+
+        assert(id < PRODUCERS_NUM);
+        assert(pthread_equal(pthread_self(), consumer) != 0);
+
+        /* event cannot be received before it was triggered */
+        received_cntr[id]++;
+        received_total++;
+        assert(received_cntr[id] <= atomic_load(&sent_cntr[id]));
+
+        *data_size = snprintf((char *)data, max_data_size, "%u", (unsigned)received_cntr[id]);
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[16];
+static struct cat_unsolicited_cmd unsolicited_low_cmd_buf[8];
+static struct cat_unsolicited_cmd unsolicited_high_cmd_buf[8];
+
+static struct cat_command_group cmd_group = {
+        .cmd = u_cmds,
+        .cmd_num = sizeof(u_cmds) / sizeof(u_cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+        .unsolicited_low_cmd_buf = unsolicited_low_cmd_buf,
+        .unsolicited_low_cmd_buf_num = sizeof(unsolicited_low_cmd_buf) / sizeof(unsolicited_low_cmd_buf[0]),
+        .unsolicited_high_cmd_buf = unsolicited_high_cmd_buf,
+        .unsolicited_high_cmd_buf_num = sizeof(unsolicited_high_cmd_buf) / sizeof(unsolicited_high_cmd_buf[0]),
+
+        .unsolicited_batch = true
+};
+
+static int write_char(char ch)
+{
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        return 0;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static pthread_mutex_t lock_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int lock(void)
+{
+        /* only consumer is allowed to take the mutex */
+        assert(pthread_equal(pthread_self(), consumer) != 0);
+        return pthread_mutex_lock(&lock_mutex);
+}
+
+static int unlock(void)
+{
+        return pthread_mutex_unlock(&lock_mutex);
+}
+
+static struct cat_mutex_interface mutex = {
+        .lock = lock,
+        .unlock = unlock
+};
+
+static void* producer_thread(void *arg)
+{
+        size_t id = (size_t)arg;
+        size_t i;
+        cat_status s;
+        /* producers are spread over all priority queues */
+        cat_unsolicited_priority priority = id % CAT_UNSOLICITED_PRIORITY__TOTAL_NUM;
+
+        for (i = 0; i < EVENTS_NUM; i++) {
+                /* count before trigger, so consumer never sees more events than sent */
+                atomic_fetch_add(&sent_cntr[id], 1);
+                while ((s = cat_trigger_unsolicited_event_priority(&at, &u_cmds[id], CAT_CMD_TYPE_READ, priority)) == CAT_STATUS_ERROR_BUFFER_FULL)
+                        sched_yield();
+                assert(s == CAT_STATUS_OK);
+        }
+
+        return NULL;
+}
+
+int main(int argc, char **argv)
+{
+        pthread_t producers[PRODUCERS_NUM];
+        struct cat_unsolicited_queue_stats stats;
+        size_t i;
+
+        consumer = pthread_self();
+
+        cat_init(&at, &desc, &iface, &mutex);
+
+        for (i = 0; i < PRODUCERS_NUM; i++)
+                assert(pthread_create(&producers[i], NULL, producer_thread, (void *)i) == 0);
+
+        while (received_total < PRODUCERS_NUM * EVENTS_NUM) {
+                /* give producers a chance to run on single core hosts */
+                if (cat_service(&at) == CAT_STATUS_OK)
+                        sched_yield();
+        }
+
+        for (i = 0; i < PRODUCERS_NUM; i++)
+                assert(pthread_join(producers[i], NULL) == 0);
+
+        while (cat_service(&at) != CAT_STATUS_OK) {};
+
+        for (i = 0; i < PRODUCERS_NUM; i++) {
+                assert(received_cntr[i] == EVENTS_NUM);
+                assert(cat_is_unsolicited_event_buffered(&at, &u_cmds[i], CAT_CMD_TYPE_NONE) == CAT_STATUS_OK);
+        }
+        assert(cat_is_unsolicited_buffer_full(&at) == CAT_STATUS_OK);
+
+        for (i = 0; i < CAT_UNSOLICITED_PRIORITY__TOTAL_NUM; i++) {
+                assert(cat_get_unsolicited_queue_stats(&at, i, &stats, false) == CAT_STATUS_OK);
+                assert(stats.depth == 0);
+                assert((stats.high_water_mark > 0) && (stats.high_water_mark <= stats.capacity));
+        }
+
+        return 0;
+}
@@ -100,6 +100,7 @@ static struct cat_command u_cmds[] = {
 };
 
 static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
 
 static struct cat_command_group cmd_group = {
         .cmd = cmds,
@@ -116,6 +117,8 @@ static struct cat_descriptor desc = {
 
         .buf = buf,
         .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
 };
 
 static int write_char(char ch)
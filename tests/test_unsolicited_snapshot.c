@@ -0,0 +1,314 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char ack_results[256];
+static size_t write_cntr;
+static size_t read_cntr;
+static int32_t val;
+
+static bool mutex_used;
+static int mutex_depth;
+static size_t mutex_lock_cntr;
+static int mutex_ret_lock;
+static int mutex_ret_unlock;
+
+static int mutex_lock(void)
+{
+        if (mutex_ret_lock != 0)
+                return mutex_ret_lock;
+
+        assert(mutex_depth == 0);
+        mutex_depth++;
+        mutex_lock_cntr++;
+        return 0;
+}
+
+static int mutex_unlock(void)
+{
+        assert(mutex_depth == 1);
+        if (mutex_ret_unlock != 0)
+                return mutex_ret_unlock;
+
+        mutex_depth--;
+        return 0;
+}
+
+static struct cat_mutex_interface mutex = {
+        .lock = mutex_lock,
+        .unlock = mutex_unlock
+};
+
+static int var_read(const struct cat_variable *var)
+{
+        /* variables are read only with parser mutex locked */
+        assert((mutex_used == false) || (mutex_depth == 1));
+        return 0;
+}
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        read_cntr++;
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static struct cat_variable vars[] = {
+        {
+                .type = CAT_VAR_INT_DEC,
+                .data = &val,
+                .data_size = sizeof(val),
+                .read = var_read
+        }
+};
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+VAL",
+                .read = cmd_read,
+                .var = vars,
+                .var_num = sizeof(vars) / sizeof(vars[0])
+        }
+};
+
+static char buf[64];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static char unsolicited_buf[24];
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[4];
+static struct cat_unsolicited_cmd unsolicited_high_cmd_buf[2];
+static char unsolicited_arena_buf[6 * 16];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_buf = unsolicited_buf,
+        .unsolicited_buf_size = sizeof(unsolicited_buf),
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+        .unsolicited_high_cmd_buf = unsolicited_high_cmd_buf,
+        .unsolicited_high_cmd_buf_num = sizeof(unsolicited_high_cmd_buf) / sizeof(unsolicited_high_cmd_buf[0]),
+
+        .unsolicited_arena_buf = unsolicited_arena_buf,
+        .unsolicited_arena_buf_size = sizeof(unsolicited_arena_buf),
+        .unsolicited_arena_slot_size = 16
+};
+
+static struct cat_descriptor batch_desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_buf = unsolicited_buf,
+        .unsolicited_buf_size = sizeof(unsolicited_buf),
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+
+        .unsolicited_arena_buf = unsolicited_arena_buf,
+        .unsolicited_arena_buf_size = sizeof(unsolicited_arena_buf),
+        .unsolicited_arena_slot_size = 16,
+
+        .unsolicited_batch = true
+};
+
+static size_t write_iov(const struct cat_io_vec *iov, size_t iov_num)
+{
+        size_t i;
+        size_t n = 0;
+
+        for (i = 0; i < iov_num; i++) {
+                strncat(ack_results, iov[i].base, iov[i].len);
+                n += iov[i].len;
+        }
+        /* each call is single output transaction */
+        strcat(ack_results, "|");
+        write_cntr++;
+        return n;
+}
+
+static int read_char(char *ch)
+{
+        return 0;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write_iov = write_iov
+};
+
+static void prepare_results(void)
+{
+        memset(ack_results, 0, sizeof(ack_results));
+        write_cntr = 0;
+        read_cntr = 0;
+}
+
+static void snapshot(struct cat_object *self, cat_unsolicited_priority priority)
+{
+        char args[16];
+
+        sprintf(args, "%d", (int)val);
+        assert(cat_trigger_unsolicited_snapshot(self, &cmds[0], args, priority) == CAT_STATUS_OK);
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+
+        cat_init(&at, &desc, &iface, NULL);
+
+        /* snapshot keeps value from trigger time, regular event reports actual value */
+        prepare_results();
+        val = 1;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        val = 2;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        val = 5;
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+VAL=1\n|\n+VAL=2\n|\n+VAL=5\n|") == 0);
+        assert(read_cntr == 1);
+
+        /* high priority snapshot is flushed first */
+        prepare_results();
+        val = 3;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        val = 4;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_HIGH);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+VAL=4\n|\n+VAL=3\n|") == 0);
+        assert(read_cntr == 0);
+
+        /* response not fitting into slot is rejected */
+        assert(cat_trigger_unsolicited_snapshot(&at, &cmds[0], "12345678901", CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_ERROR);
+        assert(cat_trigger_unsolicited_snapshot(&at, &cmds[0], "1234567890", CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_OK);
+
+        /* every queue item has own slot */
+        val = 6;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        assert(cat_trigger_unsolicited_snapshot(&at, &cmds[0], "7", CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_ERROR_BUFFER_FULL);
+
+        prepare_results();
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+VAL=1234567890\n|\n+VAL=6\n|\n+VAL=6\n|\n+VAL=6\n|") == 0);
+
+        /* variables snapshot is formatted from command variables at trigger time */
+        prepare_results();
+        val = 8;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_OK);
+        val = 9;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_OK);
+        val = 10;
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+VAL=8\n|\n+VAL=9\n|") == 0);
+        assert(read_cntr == 0);
+
+        /* variables not fitting into slot are rejected and their buffer item is released without output */
+        prepare_results();
+        val = -1234567890;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_ERROR);
+        assert(cat_is_unsolicited_event_buffered(&at, &cmds[0], CAT_CMD_TYPE_READ) == CAT_STATUS_OK);
+        val = 11;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_OK);
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+VAL=11\n|") == 0);
+
+        /* variables are formatted with mutex locked, event is buffered and flushed after unlock */
+        cat_init(&at, &desc, &iface, &mutex);
+        mutex_used = true;
+        prepare_results();
+        mutex_lock_cntr = 0;
+        val = 12;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_OK);
+        assert(mutex_depth == 0);
+        assert(mutex_lock_cntr == 1);
+
+        mutex_ret_lock = 1;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_ERROR_MUTEX_LOCK);
+        mutex_ret_lock = 0;
+
+        /* event formatted before failed unlock is dropped */
+        mutex_ret_unlock = 1;
+        assert(cat_trigger_unsolicited_var_snapshot(&at, &cmds[0], CAT_UNSOLICITED_PRIORITY_NORMAL) == CAT_STATUS_ERROR_MUTEX_UNLOCK);
+        mutex_ret_unlock = 0;
+        mutex_depth = 0;
+
+        while (cat_service(&at) != 0) {};
+        assert(mutex_depth == 0);
+
+        assert(strcmp(ack_results, "\n+VAL=12\n|") == 0);
+
+        /* snapshots are batched, snapshot not fitting into rest of buffer is flushed in next batch */
+        cat_init(&at, &batch_desc, &iface, NULL);
+        mutex_used = false;
+        prepare_results();
+        val = 1;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        val = 2;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        val = 12345;
+        snapshot(&at, CAT_UNSOLICITED_PRIORITY_NORMAL);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        val = 7;
+        while (cat_service(&at) != 0) {};
+
+        assert(strcmp(ack_results, "\n+VAL=1\n\n+VAL=2\n|\n+VAL=12345\n\n+VAL=7\n|") == 0);
+        assert(read_cntr == 1);
+
+        return 0;
+}
@@ -0,0 +1,201 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char ack_results[256];
+static const char *input_text;
+static bool writable;
+static uint32_t now_us;
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static cat_return_state cmd_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_OK;
+}
+
+static cat_return_state hold_run(const struct cat_command *cmd)
+{
+        return CAT_RETURN_STATE_HOLD;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+PING",
+                .run = cmd_run,
+                .read = cmd_read
+        },
+        {
+                .name = "+HOLD",
+                .run = hold_run
+        }
+};
+
+static char buf[128];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+static struct cat_unsolicited_cmd unsolicited_cmd_buf[4];
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm,
+
+        .unsolicited_cmd_buf = unsolicited_cmd_buf,
+        .unsolicited_cmd_buf_num = sizeof(unsolicited_cmd_buf) / sizeof(unsolicited_cmd_buf[0]),
+
+        .unsolicited_rate = 1,
+        .unsolicited_rate_burst = 1,
+        .unsolicited_rate_unit = CAT_UNSOLICITED_RATE_UNIT_LINE
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+
+        if (writable == false)
+                return 0;
+
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static int read_char(char *ch)
+{
+        if ((input_text == NULL) || (*input_text == 0))
+                return 0;
+
+        *ch = *input_text++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static uint32_t get_time_us(void)
+{
+        return now_us;
+}
+
+static struct cat_clock_interface clock_iface = {
+        .get_time_us = get_time_us
+};
+
+static cat_wait_hint service(struct cat_object *self)
+{
+        cat_wait_hint hint;
+
+        cat_service_run(self, 1000, NULL);
+        assert(cat_get_wait_hint(self, &hint) == CAT_STATUS_OK);
+        return hint;
+}
+
+int main(int argc, char **argv)
+{
+        struct cat_object at;
+        cat_wait_hint hint;
+
+        cat_init(&at, &desc, &iface, NULL);
+        memset(ack_results, 0, sizeof(ack_results));
+        writable = true;
+
+        /* idle parser waits for input */
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+
+        /* incomplete line */
+        input_text = "AT+PI";
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(cat_is_busy(&at) == CAT_STATUS_BUSY);
+
+        /* parser is progressing after single step */
+        input_text = "NG\n";
+        cat_service(&at);
+        assert(cat_get_wait_hint(&at, &hint) == CAT_STATUS_OK);
+        assert(hint == CAT_WAIT_HINT_NONE);
+
+        /* blocked output */
+        writable = false;
+        assert(service(&at) == CAT_WAIT_HINT_OUTPUT);
+        assert(strcmp(ack_results, "") == 0);
+
+        writable = true;
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\nOK\n") == 0);
+
+        /* hold state waits for hold exit or unsolicited event */
+        input_text = "AT+HOLD\n";
+        assert(service(&at) == CAT_WAIT_HINT_HOLD);
+
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        cat_service(&at);
+        assert(cat_get_wait_hint(&at, &hint) == CAT_STATUS_OK);
+        assert(hint == CAT_WAIT_HINT_NONE);
+        assert(service(&at) == CAT_WAIT_HINT_HOLD);
+        assert(strcmp(ack_results, "\nOK\n\n+PING=\n") == 0);
+
+        assert(cat_hold_exit(&at, CAT_STATUS_OK) == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\nOK\n\n+PING=\n\nOK\n") == 0);
+
+        /* unsolicited response waits for rate limit tokens */
+        cat_set_clock_interface(&at, &clock_iface);
+        memset(ack_results, 0, sizeof(ack_results));
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+        assert(service(&at) == CAT_WAIT_HINT_RATE_LIMIT);
+        assert(strcmp(ack_results, "\n+PING=\n") == 0);
+
+        now_us += 1000000;
+        assert(service(&at) == CAT_WAIT_HINT_INPUT);
+        assert(strcmp(ack_results, "\n+PING=\n\n+PING=\n") == 0);
+
+        return 0;
+}
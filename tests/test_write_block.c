@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <assert.h>
+
+#include "../src/cat.h"
+
+static char ack_results[1024];
+
+static char const *input_text;
+static size_t input_index;
+static size_t accept_size;
+static size_t write_calls;
+
+static struct cat_object at;
+static struct cat_command cmds[];
+
+static cat_return_state cmd_read(const struct cat_command *cmd, uint8_t *data, size_t *data_size, const size_t max_data_size)
+{
+        size_t i;
+
+        if (strcmp(cmd->name, "+CMD") == 0)
+                assert(cat_trigger_unsolicited_read(&at, &cmds[0]) == CAT_STATUS_OK);
+
+        for (i = 0; (i < 100) && (i < max_data_size - 1); i++)
+                data[i] = 'a' + (i % 26);
+        data[i] = 0;
+        *data_size = i;
+
+        return CAT_RETURN_STATE_DATA_OK;
+}
+
+static struct cat_command cmds[] = {
+        {
+                .name = "+LONG",
+                .read = cmd_read
+        },
+        {
+                .name = "+CMD",
+                .read = cmd_read
+        },
+};
+
+static char buf[512];
+static struct cat_unsolicited_fsm unsolicited_fsm;
+
+static struct cat_command_group cmd_group = {
+        .cmd = cmds,
+        .cmd_num = sizeof(cmds) / sizeof(cmds[0]),
+};
+
+static struct cat_command_group *cmd_desc[] = {
+        &cmd_group
+};
+
+static struct cat_descriptor desc = {
+        .cmd_group = cmd_desc,
+        .cmd_group_num = sizeof(cmd_desc) / sizeof(cmd_desc[0]),
+
+        .buf = buf,
+        .buf_size = sizeof(buf),
+
+        .unsolicited_fsm = &unsolicited_fsm
+};
+
+static int write_char(char ch)
+{
+        char str[2];
+        str[0] = ch;
+        str[1] = 0;
+        strcat(ack_results, str);
+        return 1;
+}
+
+static size_t write_block(const char *data, size_t len)
+{
+        /* every second call is rejected to emulate busy output */
+        if ((write_calls++ % 2) != 0)
+                return 0;
+
+        if (len > accept_size)
+                len = accept_size;
+
+        strncat(ack_results, data, len);
+        return len;
+}
+
+static int read_char(char *ch)
+{
+        if (input_index >= strlen(input_text))
+                return 0;
+
+        *ch = input_text[input_index];
+        input_index++;
+        return 1;
+}
+
+static struct cat_io_interface iface = {
+        .read = read_char,
+        .write = write_char
+};
+
+static struct cat_io_interface block_iface = {
+        .read = read_char,
+        .write_block = write_block
+};
+
+static void prepare_input(const char *text)
+{
+        input_text = text;
+        input_index = 0;
+        write_calls = 0;
+
+        memset(ack_results, 0, sizeof(ack_results));
+}
+
+static const char test_case_1[] = "\nAT+LONG?\r\nAT+CMD?\nAT+X\n";
+
+static size_t run_test_case(struct cat_object *self, const char *text, char *ack_out)
+{
+        size_t service_cntr = 0;
+
+        prepare_input(text);
+        while (cat_service(self) != 0)
+                service_cntr++;
+
+        strcpy(ack_out, ack_results);
+        return service_cntr;
+}
+
+int main(int argc, char **argv)
+{
+        static char char_ack[1024];
+        static char block_ack[1024];
+        size_t char_service_cntr;
+        size_t block_service_cntr;
+
+        cat_init(&at, &desc, &iface, NULL);
+        char_service_cntr = run_test_case(&at, test_case_1, char_ack);
+
+        assert(strstr(char_ack, "\r\nabcdefghijklmnopqrstuvwxyzabcd") == char_ack);
+        assert(strstr(char_ack, "\nERROR\n") != NULL);
+
+        cat_init(&at, &desc, &block_iface, NULL);
+
+        for (accept_size = 1; accept_size <= 8; accept_size++) {
+                run_test_case(&at, test_case_1, block_ack);
+                assert(strcmp(block_ack, char_ack) == 0);
+        }
+
+        accept_size = sizeof(char_ack);
+        block_service_cntr = run_test_case(&at, test_case_1, block_ack);
+        assert(strcmp(block_ack, char_ack) == 0);
+
+        /* whole spans are handed over instead of single chars */
+        assert(block_service_cntr * 3 < char_service_cntr);
+
+        return 0;
+}
@@ -0,0 +1,684 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+ * cat-gen - offline commands table generator
+ *
+ * Usage: cat-gen <spec> <output.c> <output.h>
+ *
+ * Spec file is line oriented, '#' starts a comment:
+ *
+ *   prefix <c identifier>            symbols prefix of generated tables (default "cat_gen")
+ *   include <header>                 header with handlers and variables declarations
+ *   group <name> [disable]           starts new commands group
+ *   command <name>                   starts new command in current group
+ *   description "<text>"             command description
+ *   write|read|run|test <function>   command handlers
+ *   need_all_vars|only_test|disable|implicit_write
+ *                                    command flags
+ *   var <name|-> <int|uint|hex|hexbuf|string> <data symbol> [rw|ro|wo] [write=<fn>] [read=<fn>]
+ *                                    variable attached to current command
+ *
+ * Generated source contains commands groups arrays and cat_command_hash table
+ * with minimal perfect hash of upper-cased commands names, which can be
+ * attached to cat_descriptor. All descriptor checks normally done by cat_init
+ * are done here.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#include "../src/cat.h"
+
+#define MAX_TOKENS_NUM (8U)
+#define MAX_LINE_SIZE (1024U)
+#define MAX_SEED (1000000U)
+
+struct gen_var {
+        char *name;
+        char *type;
+        char *data;
+        char *access;
+        char *write;
+        char *read;
+};
+
+struct gen_cmd {
+        char *name;
+        char *upper_name;
+        char *description;
+        char *write;
+        char *read;
+        char *run;
+        char *test;
+        bool need_all_vars;
+        bool only_test;
+        bool disable;
+        bool implicit_write;
+
+        struct gen_var *var;
+        size_t var_num;
+
+        size_t group;
+        int line;
+};
+
+struct gen_group {
+        char *name;
+        bool disable;
+        size_t cmd_begin;
+        size_t cmd_num;
+};
+
+static char const *spec_file;
+static char *prefix;
+static char **includes;
+static size_t includes_num;
+static struct gen_group *groups;
+static size_t groups_num;
+static struct gen_cmd *cmds;
+static size_t cmds_num;
+
+static void fail(int line, const char *fmt, ...)
+{
+        va_list args;
+
+        fprintf(stderr, "%s:%d: error: ", spec_file, line);
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+        fprintf(stderr, "\n");
+        exit(1);
+}
+
+static void *grow(void *ptr, size_t num, size_t item_size)
+{
+        ptr = realloc(ptr, (num + 1) * item_size);
+        if (ptr == NULL) {
+                fprintf(stderr, "out of memory\n");
+                exit(1);
+        }
+        memset((char *)ptr + num * item_size, 0, item_size);
+        return ptr;
+}
+
+static char *copy_string(const char *str)
+{
+        char *s = malloc(strlen(str) + 1);
+
+        if (s == NULL) {
+                fprintf(stderr, "out of memory\n");
+                exit(1);
+        }
+        strcpy(s, str);
+        return s;
+}
+
+static char to_upper(char ch)
+{
+        return (ch >= 'a' && ch <= 'z') ? ch - ('a' - 'A') : ch;
+}
+
+static bool is_valid_cmd_name_char(const char ch)
+{
+        return (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || (ch == '+') || (ch == '#') || (ch == '$') || (ch == '@') || (ch == '_') || (ch == '%') || (ch == '&');
+}
+
+static bool is_identifier(const char *str)
+{
+        if ((*str == '\0') || ((*str >= '0') && (*str <= '9')))
+                return false;
+
+        for (; *str != '\0'; str++) {
+                if (!(((*str >= 'a') && (*str <= 'z')) || ((*str >= 'A') && (*str <= 'Z')) || ((*str >= '0') && (*str <= '9')) || (*str == '_')))
+                        return false;
+        }
+        return true;
+}
+
+static size_t tokenize(char *line, char **tokens, int line_num)
+{
+        size_t num = 0;
+        char *p = line;
+        char *out;
+
+        while (1) {
+                while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))
+                        p++;
+                if ((*p == '\0') || (*p == '#'))
+                        break;
+                if (num >= MAX_TOKENS_NUM)
+                        fail(line_num, "too many tokens");
+
+                if (*p == '"') {
+                        /* quoted string, escapes are kept as they are in C string literal */
+                        tokens[num++] = p;
+                        out = p++;
+                        *out++ = '"';
+                        while ((*p != '"') && (*p != '\0')) {
+                                if ((*p == '\\') && (p[1] != '\0'))
+                                        *out++ = *p++;
+                                *out++ = *p++;
+                        }
+                        if (*p != '"')
+                                fail(line_num, "unterminated string");
+                        p++;
+                        *out++ = '"';
+                        if ((*p != '\0') && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+                                fail(line_num, "unexpected char after string");
+                        if (*p != '\0')
+                                p++;
+                        *out = '\0';
+                        continue;
+                }
+
+                tokens[num++] = p;
+                while ((*p != '\0') && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+                        p++;
+                if (*p != '\0')
+                        *p++ = '\0';
+        }
+
+        return num;
+}
+
+static struct gen_cmd *get_current_cmd(int line, const char *keyword)
+{
+        if ((cmds_num == 0) || (cmds[cmds_num - 1].group != groups_num - 1))
+                fail(line, "'%s' outside of command", keyword);
+        return &cmds[cmds_num - 1];
+}
+
+static void set_handler(char **handler, char **tokens, size_t num, int line)
+{
+        if (num != 2)
+                fail(line, "'%s' needs function name", tokens[0]);
+        if (*handler != NULL)
+                fail(line, "'%s' handler already defined", tokens[0]);
+        if (is_identifier(tokens[1]) == false)
+                fail(line, "invalid function name '%s'", tokens[1]);
+        *handler = copy_string(tokens[1]);
+}
+
+static void parse_var(struct gen_cmd *cmd, char **tokens, size_t num, int line)
+{
+        struct gen_var *var;
+        size_t i;
+        static const char *types[][2] = {
+                {"int", "CAT_VAR_INT_DEC"},
+                {"uint", "CAT_VAR_UINT_DEC"},
+                {"hex", "CAT_VAR_NUM_HEX"},
+                {"hexbuf", "CAT_VAR_BUF_HEX"},
+                {"string", "CAT_VAR_BUF_STRING"},
+        };
+        static const char *accessors[][2] = {
+                {"rw", "CAT_VAR_ACCESS_READ_WRITE"},
+                {"ro", "CAT_VAR_ACCESS_READ_ONLY"},
+                {"wo", "CAT_VAR_ACCESS_WRITE_ONLY"},
+        };
+
+        if (num < 4)
+                fail(line, "'var' needs name, type and data symbol");
+
+        cmd->var = grow(cmd->var, cmd->var_num, sizeof(cmd->var[0]));
+        var = &cmd->var[cmd->var_num++];
+
+        if (strcmp(tokens[1], "-") != 0)
+                var->name = copy_string(tokens[1]);
+
+        for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+                if (strcmp(tokens[2], types[i][0]) == 0)
+                        var->type = copy_string(types[i][1]);
+        }
+        if (var->type == NULL)
+                fail(line, "unknown variable type '%s'", tokens[2]);
+
+        if (is_identifier(tokens[3]) == false)
+                fail(line, "invalid data symbol '%s'", tokens[3]);
+        var->data = copy_string(tokens[3]);
+
+        var->access = copy_string(accessors[0][1]);
+        for (i = 4; i < num; i++) {
+                if (strncmp(tokens[i], "write=", 6) == 0) {
+                        if (is_identifier(&tokens[i][6]) == false)
+                                fail(line, "invalid function name '%s'", &tokens[i][6]);
+                        var->write = copy_string(&tokens[i][6]);
+                } else if (strncmp(tokens[i], "read=", 5) == 0) {
+                        if (is_identifier(&tokens[i][5]) == false)
+                                fail(line, "invalid function name '%s'", &tokens[i][5]);
+                        var->read = copy_string(&tokens[i][5]);
+                } else {
+                        size_t j;
+                        bool found = false;
+
+                        for (j = 0; j < sizeof(accessors) / sizeof(accessors[0]); j++) {
+                                if (strcmp(tokens[i], accessors[j][0]) == 0) {
+                                        free(var->access);
+                                        var->access = copy_string(accessors[j][1]);
+                                        found = true;
+                                }
+                        }
+                        if (found == false)
+                                fail(line, "unknown variable attribute '%s'", tokens[i]);
+                }
+        }
+}
+
+static void parse_spec(FILE *f)
+{
+        char line[MAX_LINE_SIZE];
+        char *tokens[MAX_TOKENS_NUM];
+        size_t num;
+        size_t i;
+        int line_num = 0;
+        struct gen_cmd *cmd;
+
+        while (fgets(line, sizeof(line), f) != NULL) {
+                line_num++;
+
+                num = tokenize(line, tokens, line_num);
+                if (num == 0)
+                        continue;
+
+                if (strcmp(tokens[0], "prefix") == 0) {
+                        if ((num != 2) || (is_identifier(tokens[1]) == false))
+                                fail(line_num, "'prefix' needs c identifier");
+                        free(prefix);
+                        prefix = copy_string(tokens[1]);
+                } else if (strcmp(tokens[0], "include") == 0) {
+                        if (num != 2)
+                                fail(line_num, "'include' needs header name");
+                        includes = grow(includes, includes_num, sizeof(includes[0]));
+                        includes[includes_num++] = copy_string(tokens[1]);
+                } else if (strcmp(tokens[0], "group") == 0) {
+                        if ((num < 2) || (num > 3) || ((num == 3) && (strcmp(tokens[2], "disable") != 0)))
+                                fail(line_num, "'group' needs name and optional 'disable' flag");
+                        groups = grow(groups, groups_num, sizeof(groups[0]));
+                        groups[groups_num].name = copy_string(tokens[1]);
+                        groups[groups_num].disable = (num == 3);
+                        groups[groups_num].cmd_begin = cmds_num;
+                        groups_num++;
+                } else if (strcmp(tokens[0], "command") == 0) {
+                        if (groups_num == 0)
+                                fail(line_num, "'command' outside of group");
+                        if (num != 2)
+                                fail(line_num, "'command' needs name");
+                        cmds = grow(cmds, cmds_num, sizeof(cmds[0]));
+                        cmd = &cmds[cmds_num++];
+                        cmd->name = copy_string(tokens[1]);
+                        cmd->upper_name = copy_string(tokens[1]);
+                        for (i = 0; cmd->upper_name[i] != '\0'; i++)
+                                cmd->upper_name[i] = to_upper(cmd->upper_name[i]);
+                        cmd->group = groups_num - 1;
+                        cmd->line = line_num;
+                        groups[groups_num - 1].cmd_num++;
+                } else if (strcmp(tokens[0], "description") == 0) {
+                        cmd = get_current_cmd(line_num, tokens[0]);
+                        if ((num != 2) || (tokens[1][0] != '"'))
+                                fail(line_num, "'description' needs quoted string");
+                        cmd->description = copy_string(tokens[1]);
+                } else if (strcmp(tokens[0], "write") == 0) {
+                        set_handler(&get_current_cmd(line_num, tokens[0])->write, tokens, num, line_num);
+                } else if (strcmp(tokens[0], "read") == 0) {
+                        set_handler(&get_current_cmd(line_num, tokens[0])->read, tokens, num, line_num);
+                } else if (strcmp(tokens[0], "run") == 0) {
+                        set_handler(&get_current_cmd(line_num, tokens[0])->run, tokens, num, line_num);
+                } else if (strcmp(tokens[0], "test") == 0) {
+                        set_handler(&get_current_cmd(line_num, tokens[0])->test, tokens, num, line_num);
+                } else if (strcmp(tokens[0], "need_all_vars") == 0) {
+                        get_current_cmd(line_num, tokens[0])->need_all_vars = true;
+                } else if (strcmp(tokens[0], "only_test") == 0) {
+                        get_current_cmd(line_num, tokens[0])->only_test = true;
+                } else if (strcmp(tokens[0], "disable") == 0) {
+                        get_current_cmd(line_num, tokens[0])->disable = true;
+                } else if (strcmp(tokens[0], "implicit_write") == 0) {
+                        get_current_cmd(line_num, tokens[0])->implicit_write = true;
+                } else if (strcmp(tokens[0], "var") == 0) {
+                        parse_var(get_current_cmd(line_num, tokens[0]), tokens, num, line_num);
+                } else {
+                        fail(line_num, "unknown keyword '%s'", tokens[0]);
+                }
+        }
+}
+
+static void validate_spec(void)
+{
+        size_t i, j;
+        struct gen_cmd *cmd;
+
+        if (groups_num == 0)
+                fail(0, "no commands groups defined");
+
+        for (i = 0; i < groups_num; i++) {
+                if (groups[i].cmd_num == 0)
+                        fail(0, "group '%s' has no commands", groups[i].name);
+        }
+
+        for (i = 0; i < cmds_num; i++) {
+                cmd = &cmds[i];
+
+                if (cmd->name[0] == '\0')
+                        fail(cmd->line, "empty command name");
+                for (j = 0; cmd->upper_name[j] != '\0'; j++) {
+                        if (is_valid_cmd_name_char(cmd->upper_name[j]) == false)
+                                fail(cmd->line, "invalid char '%c' in command name '%s'", cmd->name[j], cmd->name);
+                }
+                if ((cmd->implicit_write != false) && ((cmd->read != NULL) || (cmd->run != NULL) || (cmd->test != NULL)))
+                        fail(cmd->line, "implicit write command '%s' can have only write handler", cmd->name);
+
+                for (j = 0; j < i; j++) {
+                        if (strcmp(cmds[j].upper_name, cmd->upper_name) == 0)
+                                fail(cmd->line, "command '%s' already defined in line %d", cmd->name, cmds[j].line);
+                }
+        }
+}
+
+static uint32_t hash_name(const char *name)
+{
+        uint32_t hash = CAT_HASH_INIT;
+
+        while (*name != '\0')
+                hash = cat_hash_update(hash, *name++);
+
+        return hash;
+}
+
+static size_t *sort_buckets;
+static size_t *bucket_size;
+
+static int compare_buckets(const void *a, const void *b)
+{
+        size_t size_a = bucket_size[*(const size_t *)a];
+        size_t size_b = bucket_size[*(const size_t *)b];
+
+        if (size_a != size_b)
+                return (size_a > size_b) ? -1 : 1;
+        return (*(const size_t *)a < *(const size_t *)b) ? -1 : 1;
+}
+
+static void build_hash(uint32_t *seed, size_t seed_num, size_t *slot_index)
+{
+        size_t i, j, k, n;
+        size_t bucket;
+        uint32_t s;
+        uint32_t *hash = calloc(cmds_num, sizeof(uint32_t));
+        size_t *slots = calloc(cmds_num, sizeof(size_t));
+        size_t *members = calloc(cmds_num, sizeof(size_t));
+        bool *used = calloc(cmds_num, sizeof(bool));
+        bool ok;
+
+        sort_buckets = calloc(seed_num, sizeof(size_t));
+        bucket_size = calloc(seed_num, sizeof(size_t));
+
+        if ((hash == NULL) || (slots == NULL) || (members == NULL) || (used == NULL) || (sort_buckets == NULL) || (bucket_size == NULL)) {
+                fprintf(stderr, "out of memory\n");
+                exit(1);
+        }
+
+        for (i = 0; i < cmds_num; i++) {
+                hash[i] = hash_name(cmds[i].upper_name);
+                bucket_size[hash[i] % seed_num]++;
+        }
+        for (i = 0; i < seed_num; i++)
+                sort_buckets[i] = i;
+
+        /* place biggest buckets first, they are the hardest to displace */
+        qsort(sort_buckets, seed_num, sizeof(size_t), compare_buckets);
+
+        for (i = 0; i < seed_num; i++) {
+                bucket = sort_buckets[i];
+                seed[bucket] = 0;
+                if (bucket_size[bucket] == 0)
+                        continue;
+
+                n = 0;
+                for (j = 0; j < cmds_num; j++) {
+                        if (hash[j] % seed_num == bucket)
+                                members[n++] = j;
+                }
+
+                for (s = 0; s < MAX_SEED; s++) {
+                        ok = true;
+                        for (j = 0; (j < n) && (ok != false); j++) {
+                                slots[j] = cat_hash_mix(hash[members[j]], s) % cmds_num;
+                                if (used[slots[j]] != false)
+                                        ok = false;
+                                for (k = 0; (k < j) && (ok != false); k++) {
+                                        if (slots[k] == slots[j])
+                                                ok = false;
+                                }
+                        }
+                        if (ok != false)
+                                break;
+                }
+                if (s >= MAX_SEED)
+                        fail(0, "cannot build perfect hash table");
+
+                seed[bucket] = s;
+                for (j = 0; j < n; j++) {
+                        used[slots[j]] = true;
+                        slot_index[slots[j]] = members[j];
+                }
+        }
+
+        free(hash);
+        free(slots);
+        free(members);
+        free(used);
+        free(sort_buckets);
+        free(bucket_size);
+}
+
+static const char *get_base_name(const char *path)
+{
+        const char *p = strrchr(path, '/');
+
+        return (p != NULL) ? p + 1 : path;
+}
+
+static void print_handler(FILE *f, const char *field, const char *handler)
+{
+        if (handler != NULL)
+                fprintf(f, "                .%s = %s,\n", field, handler);
+}
+
+static void generate_source(FILE *f, const char *header)
+{
+        size_t i, j, g;
+        size_t seed_num = (cmds_num + 1) / 2;
+        uint32_t *seed = calloc(seed_num, sizeof(uint32_t));
+        size_t *slot_index = calloc(cmds_num, sizeof(size_t));
+        struct gen_cmd *cmd;
+        struct gen_var *var;
+
+        if ((seed == NULL) || (slot_index == NULL)) {
+                fprintf(stderr, "out of memory\n");
+                exit(1);
+        }
+
+        build_hash(seed, seed_num, slot_index);
+
+        fprintf(f, "/* generated by cat-gen from %s, do not edit */\n\n", get_base_name(spec_file));
+        fprintf(f, "#include \"cat.h\"\n");
+        fprintf(f, "#include \"%s\"\n", header);
+        for (i = 0; i < includes_num; i++)
+                fprintf(f, "#include %s\n", includes[i]);
+        fprintf(f, "\n");
+
+        for (i = 0; i < cmds_num; i++) {
+                cmd = &cmds[i];
+                if (cmd->var_num == 0)
+                        continue;
+
+                fprintf(f, "static struct cat_variable %s_cmd_%u_vars[] = {\n", prefix, (unsigned)i);
+                for (j = 0; j < cmd->var_num; j++) {
+                        var = &cmd->var[j];
+                        fprintf(f, "        {\n");
+                        if (var->name != NULL)
+                                fprintf(f, "                .name = \"%s\",\n", var->name);
+                        fprintf(f, "                .type = %s,\n", var->type);
+                        fprintf(f, "                .data = &%s,\n", var->data);
+                        fprintf(f, "                .data_size = sizeof(%s),\n", var->data);
+                        fprintf(f, "                .access = %s,\n", var->access);
+                        print_handler(f, "write", var->write);
+                        print_handler(f, "read", var->read);
+                        fprintf(f, "        },\n");
+                }
+                fprintf(f, "};\n\n");
+        }
+
+        for (g = 0; g < groups_num; g++) {
+                fprintf(f, "static struct cat_command %s_group_%u_cmds[] = {\n", prefix, (unsigned)g);
+                for (i = groups[g].cmd_begin; i < groups[g].cmd_begin + groups[g].cmd_num; i++) {
+                        cmd = &cmds[i];
+                        fprintf(f, "        {\n");
+                        fprintf(f, "                .name = \"%s\",\n", cmd->name);
+                        if (cmd->description != NULL)
+                                fprintf(f, "                .description = %s,\n", cmd->description);
+                        print_handler(f, "write", cmd->write);
+                        print_handler(f, "read", cmd->read);
+                        print_handler(f, "run", cmd->run);
+                        print_handler(f, "test", cmd->test);
+                        if (cmd->var_num > 0) {
+                                fprintf(f, "                .var = %s_cmd_%u_vars,\n", prefix, (unsigned)i);
+                                fprintf(f, "                .var_num = %u,\n", (unsigned)cmd->var_num);
+                        }
+                        if (cmd->need_all_vars != false)
+                                fprintf(f, "                .need_all_vars = true,\n");
+                        if (cmd->only_test != false)
+                                fprintf(f, "                .only_test = true,\n");
+                        if (cmd->disable != false)
+                                fprintf(f, "                .disable = true,\n");
+                        if (cmd->implicit_write != false)
+                                fprintf(f, "                .implicit_write = true,\n");
+                        fprintf(f, "        },\n");
+                }
+                fprintf(f, "};\n\n");
+
+                fprintf(f, "static struct cat_command_group %s_group_%u = {\n", prefix, (unsigned)g);
+                fprintf(f, "        .name = \"%s\",\n", groups[g].name);
+                fprintf(f, "        .cmd = %s_group_%u_cmds,\n", prefix, (unsigned)g);
+                fprintf(f, "        .cmd_num = %u,\n", (unsigned)groups[g].cmd_num);
+                if (groups[g].disable != false)
+                        fprintf(f, "        .disable = true,\n");
+                fprintf(f, "};\n\n");
+        }
+
+        fprintf(f, "struct cat_command_group *%s_cmd_group[%u] = {\n", prefix, (unsigned)groups_num);
+        for (g = 0; g < groups_num; g++)
+                fprintf(f, "        &%s_group_%u,\n", prefix, (unsigned)g);
+        fprintf(f, "};\n\n");
+
+        fprintf(f, "static const uint32_t %s_cmd_hash_seed[] = {\n", prefix);
+        for (i = 0; i < seed_num; i++)
+                fprintf(f, "        %uU,\n", (unsigned)seed[i]);
+        fprintf(f, "};\n\n");
+
+        fprintf(f, "static const size_t %s_cmd_hash_index[] = {\n", prefix);
+        for (i = 0; i < cmds_num; i++)
+                fprintf(f, "        %u, /* %s */\n", (unsigned)slot_index[i], cmds[slot_index[i]].upper_name);
+        fprintf(f, "};\n\n");
+
+        fprintf(f, "static const char * const %s_cmd_hash_name[] = {\n", prefix);
+        for (i = 0; i < cmds_num; i++)
+                fprintf(f, "        \"%s\",\n", cmds[i].upper_name);
+        fprintf(f, "};\n\n");
+
+        fprintf(f, "const struct cat_command_hash %s_cmd_hash = {\n", prefix);
+        fprintf(f, "        .seed = %s_cmd_hash_seed,\n", prefix);
+        fprintf(f, "        .seed_num = sizeof(%s_cmd_hash_seed) / sizeof(%s_cmd_hash_seed[0]),\n", prefix, prefix);
+        fprintf(f, "        .index = %s_cmd_hash_index,\n", prefix);
+        fprintf(f, "        .name = %s_cmd_hash_name,\n", prefix);
+        fprintf(f, "        .num = %u,\n", (unsigned)cmds_num);
+        fprintf(f, "};\n");
+
+        free(seed);
+        free(slot_index);
+}
+
+static void generate_header(FILE *f)
+{
+        size_t i;
+        char *upper_prefix = copy_string(prefix);
+
+        for (i = 0; upper_prefix[i] != '\0'; i++)
+                upper_prefix[i] = to_upper(upper_prefix[i]);
+
+        fprintf(f, "/* generated by cat-gen from %s, do not edit */\n\n", get_base_name(spec_file));
+        fprintf(f, "#ifndef %s_CMD_TABLE_H\n", upper_prefix);
+        fprintf(f, "#define %s_CMD_TABLE_H\n\n", upper_prefix);
+        fprintf(f, "#include \"cat.h\"\n\n");
+        fprintf(f, "#define %s_CMD_GROUP_NUM (%uU)\n", upper_prefix, (unsigned)groups_num);
+        fprintf(f, "#define %s_CMD_NUM (%uU)\n\n", upper_prefix, (unsigned)cmds_num);
+        fprintf(f, "extern struct cat_command_group *%s_cmd_group[%s_CMD_GROUP_NUM];\n", prefix, upper_prefix);
+        fprintf(f, "extern const struct cat_command_hash %s_cmd_hash;\n\n", prefix);
+        fprintf(f, "#endif /* %s_CMD_TABLE_H */\n", upper_prefix);
+
+        free(upper_prefix);
+}
+
+int main(int argc, char **argv)
+{
+        FILE *f;
+
+        if (argc != 4) {
+                fprintf(stderr, "usage: %s <spec> <output.c> <output.h>\n", argv[0]);
+                return 1;
+        }
+
+        spec_file = argv[1];
+        prefix = copy_string("cat_gen");
+
+        f = fopen(spec_file, "r");
+        if (f == NULL) {
+                perror(spec_file);
+                return 1;
+        }
+        parse_spec(f);
+        fclose(f);
+
+        validate_spec();
+
+        f = fopen(argv[2], "w");
+        if (f == NULL) {
+                perror(argv[2]);
+                return 1;
+        }
+        generate_source(f, get_base_name(argv[3]));
+        fclose(f);
+
+        f = fopen(argv[3], "w");
+        if (f == NULL) {
+                perror(argv[3]);
+                return 1;
+        }
+        generate_header(f);
+        fclose(f);
+
+        return 0;
+}
@@ -0,0 +1,249 @@
+/*
+MIT License
+
+Copyright (c) 2019 Marcin Borowicz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+ * cat-load - load generator for example epoll server (example/server.c)
+ *
+ * Usage: cat-load <socket path> [max sessions] [seconds per step] [pipeline depth]
+ *
+ * Number of concurrent sessions is doubled from 1 up to max sessions. Every session
+ * keeps pipeline depth of "AT+PING" commands in flight and counts "OK" responses,
+ * aggregate commands throughput is printed for every step.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SESSIONS_MAX (1024U)
+#define DEPTH_MAX (256U)
+#define EVENTS_NUM (64U)
+
+static const char line[] = "AT+PING\n";
+#define LINE_LEN (sizeof(line) - 1)
+
+struct connection {
+        int fd;
+        size_t in_flight; /* commands sent (or queued for sending) without response */
+        size_t to_send; /* bytes of queued commands not written yet */
+        size_t sent; /* total number of written bytes (position in repeated command line) */
+        char resp[4]; /* beginning of currently received response line */
+        size_t resp_len;
+        size_t completed;
+};
+
+static struct connection conns[SESSIONS_MAX];
+static char pattern[DEPTH_MAX * LINE_LEN];
+
+static double get_time_s(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int connect_session(const char *path)
+{
+        struct sockaddr_un addr;
+        int fd;
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+                return -1;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+                close(fd);
+                return -1;
+        }
+
+        /* non blocking mode is set after connect, so listen backlog overflow is waited out */
+        if (fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+                close(fd);
+                return -1;
+        }
+
+        return fd;
+}
+
+static void send_commands(struct connection *c, size_t depth)
+{
+        size_t offset;
+        size_t len;
+        ssize_t n;
+
+        c->to_send += (depth - c->in_flight) * LINE_LEN;
+        c->in_flight = depth;
+
+        while (c->to_send > 0) {
+                offset = c->sent % LINE_LEN;
+                len = sizeof(pattern) - offset;
+                if (len > c->to_send)
+                        len = c->to_send;
+
+                n = write(c->fd, &pattern[offset], len);
+                if (n <= 0)
+                        break;
+
+                c->sent += n;
+                c->to_send -= n;
+        }
+}
+
+static bool receive_responses(struct connection *c)
+{
+        char buf[4096];
+        ssize_t n;
+        ssize_t i;
+
+        n = read(c->fd, buf, sizeof(buf));
+        if (n == 0)
+                return false;
+        if (n < 0)
+                return (errno == EAGAIN) || (errno == EINTR);
+
+        for (i = 0; i < n; i++) {
+                if ((buf[i] == '\r') || (buf[i] == '\n')) {
+                        if ((c->resp_len == 2) && (c->resp[0] == 'O') && (c->resp[1] == 'K')) {
+                                c->completed++;
+                                c->in_flight--;
+                        }
+                        c->resp_len = 0;
+                } else if (c->resp_len < sizeof(c->resp)) {
+                        c->resp[c->resp_len++] = buf[i];
+                }
+        }
+
+        return true;
+}
+
+static int run_step(const char *path, size_t sessions_num, double duration, size_t depth)
+{
+        struct epoll_event events[EVENTS_NUM];
+        struct epoll_event ev;
+        struct connection *c;
+        size_t total = 0;
+        size_t i;
+        double start;
+        double t;
+        int epoll_fd;
+        int n;
+        int j;
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0)
+                return -1;
+
+        for (i = 0; i < sessions_num; i++) {
+                c = &conns[i];
+                memset(c, 0, sizeof(*c));
+                c->fd = connect_session(path);
+                if (c->fd < 0)
+                        return -1;
+
+                ev.events = EPOLLIN;
+                ev.data.u32 = i;
+                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, c->fd, &ev);
+        }
+
+        start = get_time_s();
+        for (i = 0; i < sessions_num; i++)
+                send_commands(&conns[i], depth);
+
+        do {
+                n = epoll_wait(epoll_fd, events, EVENTS_NUM, 100);
+                for (j = 0; j < n; j++) {
+                        c = &conns[events[j].data.u32];
+                        if (receive_responses(c) == false)
+                                return -1;
+                        send_commands(c, depth);
+                }
+                t = get_time_s() - start;
+        } while (t < duration);
+
+        for (i = 0; i < sessions_num; i++) {
+                total += conns[i].completed;
+                close(conns[i].fd);
+        }
+        close(epoll_fd);
+
+        printf("%8zu %12zu %10.2f %14.0f %14.0f\n", sessions_num, total, t, (double)total / t, (double)total / t / sessions_num);
+        fflush(stdout);
+
+        return 0;
+}
+
+int main(int argc, char **argv)
+{
+        size_t max_sessions;
+        size_t depth;
+        double duration;
+        size_t n;
+        size_t i;
+
+        if (argc < 2) {
+                fprintf(stderr, "usage: %s <socket path> [max sessions] [seconds per step] [pipeline depth]\n", argv[0]);
+                return 1;
+        }
+
+        max_sessions = (argc > 2) ? strtoul(argv[2], NULL, 0) : 64;
+        duration = (argc > 3) ? atof(argv[3]) : 2.0;
+        depth = (argc > 4) ? strtoul(argv[4], NULL, 0) : 16;
+
+        if ((max_sessions == 0) || (max_sessions > SESSIONS_MAX) || (depth == 0) || (depth > DEPTH_MAX)) {
+                fprintf(stderr, "sessions must be in range 1..%u and depth in range 1..%u\n", SESSIONS_MAX, DEPTH_MAX);
+                return 1;
+        }
+
+        for (i = 0; i < DEPTH_MAX; i++)
+                memcpy(&pattern[i * LINE_LEN], line, LINE_LEN);
+
+        printf("%8s %12s %10s %14s %14s\n", "sessions", "commands", "seconds", "commands/s", "per session/s");
+
+        for (n = 1; n <= max_sessions; n *= 2) {
+                if (run_step(argv[1], n, duration, depth) != 0) {
+                        perror("cat-load");
+                        return 1;
+                }
+                if ((n < max_sessions) && (n * 2 > max_sessions))
+                        n = max_sessions / 2;
+        }
+
+        return 0;
+}